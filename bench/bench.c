@@ -0,0 +1,655 @@
+/*
+ *  csd5127: George Kiosklis
+ *  Microbenchmarks gia ton parser, to variable expansion, ton tokenizer kai
+ *  to prompt tou libhy345sh.a, xwris fork/exec (tipota den ektelitai), kai to
+ *  kostos ekkinhshs twn pipelines
+ *
+ *  Usage: hy345sh_bench [-n LINES] [-t SECONDS]
+ *         hy345sh_bench -p [-r RUNS]   pipeline launch cost gia 2..512 stages
+ *         hy345sh_bench -s SOCKET [-r RUNS] [-x SHELL] [-c CMD]
+ *                                      latency enos request ston server (hy345sh --server)
+ *                                      se sygkrish me cold "SHELL -c CMD"
+ *         hy345sh_bench -T [-r RUNS]   pipe throughput: bursty producer -> slow consumer
+ *                                      me default pipes, PIPESIZE kai buffer stage
+ *         hy345sh_bench -W [-r RUNS]   akriveia tou timeout (deadline kai SIGKILL escalation)
+ *         hy345sh_bench -S [-n LINES] [-r RUNS] [-x SHELL]
+ *                                      startup me rc LINES grammwn: source vs --restore
+ *         hy345sh_bench -G BYTES:BURST:PAUSE_US | hy345sh_bench -C US_PER_64K
+ *                                      o producer kai o consumer tou -T
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/wait.h>
+
+#include "hy345sh.h"
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * Generated corpora: ka8e corpus einai LINES grammes, mia entolh ana grammh
+ */
+typedef struct
+{
+    const char *name;
+    StrBuf text;   /* oles oi grammes me '\n' (gia to parse) */
+    char **lines;  /* oi idies grammes xwrista (gia expand/tokenize) */
+    int nlines;
+} Corpus;
+
+static void corpus_add(Corpus *c, const char *line)
+{
+    sb_append(&c->text, line, strlen(line));
+    sb_append(&c->text, "\n", 1);
+    c->lines[c->nlines++] = my_strdup(line);
+}
+
+static void corpus_build(Corpus *c, const char *name, int n)
+{
+    char line[MAX_LINE];
+    c->name = name;
+    sb_init(&c->text);
+    c->lines = malloc(n * sizeof(char *));
+    c->nlines = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (strcmp(name, "simple") == 0)
+        {
+            snprintf(line, sizeof(line), "echo hello world %d > /tmp/out_%d.txt", i, i % 7);
+        }
+        else if (strcmp(name, "pipeline") == 0)
+        {
+            snprintf(line, sizeof(line), "cat input_%d.txt | grep -v foo | sort | uniq -c | head -%d", i, i % 10 + 1);
+        }
+        else if (strcmp(name, "control") == 0)
+        {
+            snprintf(line, sizeof(line),
+                     "for i in a b c %d; do if test $i = b; then echo $i >> log.txt; fi; done", i);
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "echo $NAME $HOME_DIR/$FILE_%d $COUNT $GREETING $missing_%d", i % 4, i);
+        }
+        corpus_add(c, line);
+    }
+}
+
+static void corpus_free(Corpus *c)
+{
+    for (int i = 0; i < c->nlines; i++)
+    {
+        free(c->lines[i]);
+    }
+    free(c->lines);
+    sb_free(&c->text);
+}
+
+static void report(const char *what, const Corpus *c, long iters, double secs)
+{
+    double bytes = (double)c->text.len * iters;
+    double cmds = (double)c->nlines * iters;
+    printf("%-10s %-9s %10.1f MB/s %10.1f ns/cmd\n", what, c->name,
+           bytes / secs / 1e6, secs * 1e9 / cmds);
+}
+
+/* parse_list() olou tou corpus (xwris ektelesh) */
+static void bench_parse(const Corpus *c, double min_secs)
+{
+    long iters = 0;
+    double start = now_sec(), elapsed;
+    do
+    {
+        Node *n = parse_list(c->text.data);
+        free_nodes(n);
+        iters++;
+        elapsed = now_sec() - start;
+    } while (elapsed < min_secs);
+    report("parse", c, iters, elapsed);
+}
+
+/* var_expansion() ana grammh */
+static void bench_expand(const Corpus *c, double min_secs)
+{
+    long iters = 0;
+    double start = now_sec(), elapsed;
+    do
+    {
+        for (int i = 0; i < c->nlines; i++)
+        {
+            var_expansion(c->lines[i]);
+        }
+        iters++;
+        elapsed = now_sec() - start;
+    } while (elapsed < min_secs);
+    report("expand", c, iters, elapsed);
+}
+
+/* var_expansion() + tokenize_cmd() ana grammh, opws sto execute_cmd() */
+static void bench_tokenize(const Corpus *c, double min_secs)
+{
+    char expanded[MAX_LINE];
+    SimpleCmd cmd;
+    long iters = 0;
+    double start = now_sec(), elapsed;
+    do
+    {
+        for (int i = 0; i < c->nlines; i++)
+        {
+            strncpy(expanded, var_expansion(c->lines[i]), MAX_LINE - 1);
+            expanded[MAX_LINE - 1] = '\0';
+            tokenize_cmd(expanded, &cmd);
+        }
+        iters++;
+        elapsed = now_sec() - start;
+    } while (elapsed < min_secs);
+    report("tokenize", c, iters, elapsed);
+}
+
+/*
+ * Prompt rendering: to compiled PS1 (prompt_render) se sygkrish me to palio
+ * display_shell (getlogin + getcwd + printf se ka8e prompt)
+ */
+static void bench_prompt(const char *ps1, double min_secs)
+{
+    StrBuf out;
+    sb_init(&out);
+    char legacy[MAX_LINE + 256];
+    long iters = 0;
+    double start = now_sec(), elapsed;
+    if (ps1 == NULL)
+    {
+        do
+        {
+            char cwd[MAX_LINE];
+            char *user = getlogin();
+            if (getcwd(cwd, sizeof(cwd)) == NULL)
+            {
+                strcpy(cwd, "uknown");
+            }
+            snprintf(legacy, sizeof(legacy), "%s@-5127-hy345sh:%s$ ", user != NULL ? user : "user", cwd);
+            iters++;
+            elapsed = now_sec() - start;
+        } while (elapsed < min_secs);
+    }
+    else
+    {
+        set_var("PS1", ps1);
+        do
+        {
+            prompt_render(&out);
+            iters++;
+            elapsed = now_sec() - start;
+        } while (elapsed < min_secs);
+    }
+    printf("%-10s %-24s %10.1f ns/prompt\n", "prompt", ps1 != NULL ? ps1 : "(getlogin+getcwd)",
+           elapsed * 1e9 / iters);
+    sb_free(&out);
+}
+
+/*
+ * Akriveia tou timeout: "timeout D sleep 10" mesw tou parse_and_exec, kai o
+ * xronos mexri na epistrepsei se sxesh me to D (overshoot = deadline -> kill ->
+ * reap). Me -k kai ena command pou agnoei to SIGTERM metraei kai to escalation
+ * (anamenomeno 2D)
+ */
+static void bench_timeout(int runs)
+{
+    static const char *durations[] = {"1ms", "10ms", "100ms"};
+    static const double secs[] = {0.001, 0.01, 0.1};
+    char ignore[64], cmd[256];
+    snprintf(ignore, sizeof(ignore), "/tmp/hy345sh-bench-ign.%d.sh", (int)getpid());
+    FILE *f = fopen(ignore, "w");
+    if (f == NULL)
+    {
+        perror(ignore);
+        return;
+    }
+    fprintf(f, "trap '' TERM\nsleep 10\n");
+    fclose(f);
+
+    shell_interactive = 0;
+    printf("%-10s %-8s %-10s %12s %12s %8s\n", "bench", "timeout", "signal", "mean over", "max over", "status");
+    for (int k = 0; k < 2; k++)
+    {
+        for (size_t d = 0; d < sizeof(durations) / sizeof(durations[0]); d++)
+        {
+            double sum = 0, max = 0;
+            double expect = k == 0 ? secs[d] : 2 * secs[d];
+            if (k == 0)
+            {
+                snprintf(cmd, sizeof(cmd), "timeout %s sleep 10", durations[d]);
+            }
+            else
+            {
+                snprintf(cmd, sizeof(cmd), "timeout %s -k %s sh %s", durations[d], durations[d], ignore);
+            }
+            for (int r = 0; r < runs; r++)
+            {
+                double start = now_sec();
+                parse_and_exec(cmd, 0);
+                double over = now_sec() - start - expect;
+                sum += over;
+                max = over > max ? over : max;
+            }
+            printf("%-10s %-8s %-10s %9.0f us %9.0f us %8d\n", "timeout", durations[d],
+                   k == 0 ? "TERM" : "TERM+KILL", sum / runs * 1e6, max * 1e6, last_exit_status);
+        }
+    }
+    unlink(ignore);
+}
+
+/*
+ * Pipeline launch: "true | true | ... | true" me n stages mesw tou pipelining()
+ * To true den kanei tipota, ara o xronos einai pipe + fork + exec + waitpid ana stage;
+ * me linear launcher to us/stage menei pano-katw sta8ero ka8ws megalwnei to n
+ */
+static void bench_pipelines(int runs)
+{
+    printf("%-10s %8s %12s %12s\n", "bench", "stages", "total", "per stage");
+    for (int n = 2; n <= 512; n *= 2)
+    {
+        StrBuf text;
+        sb_init(&text);
+        for (int i = 0; i < n; i++)
+        {
+            sb_append(&text, i > 0 ? " | true" : "true", i > 0 ? 7 : 4);
+        }
+        Node *node = parse_list(text.data);
+        double best = 0;
+        for (int r = 0; r < runs; r++)
+        {
+            double start = now_sec();
+            pipelining(node);
+            double elapsed = now_sec() - start;
+            if (r == 0 || elapsed < best)
+            {
+                best = elapsed;
+            }
+        }
+        printf("%-10s %8d %9.2f ms %9.1f us\n", "pipeline", n, best * 1e3, best * 1e6 / n);
+        free_nodes(node);
+        sb_free(&text);
+    }
+}
+
+/*
+ * Server latency: to idio CMD (default "true") me treis tropous
+ *   warm:    requests se ena anoixto connection (ena session)
+ *   connect: neo connection ana request, opws to hy345sh-client
+ *   cold:    fork + exec "SHELL -c CMD", opws ta tools xwris server
+ */
+static void report_latency(const char *what, double *samples, int runs)
+{
+    double sum = 0, min = samples[0];
+    for (int i = 0; i < runs; i++)
+    {
+        sum += samples[i];
+        min = samples[i] < min ? samples[i] : min;
+    }
+    printf("%-10s %10.1f us %10.1f us\n", what, sum * 1e6 / runs, min * 1e6);
+}
+
+static int bench_server(const char *sock_path, const char *shell, const char *cmd, int runs)
+{
+    double *samples = malloc(runs * sizeof(double));
+    int status;
+    int sock = server_connect(sock_path);
+    if (sock < 0)
+    {
+        perror(sock_path);
+        return 1;
+    }
+    printf("%-10s %13s %13s\n", "request", "mean", "min");
+    for (int i = 0; i < runs; i++)
+    {
+        double start = now_sec();
+        if (server_request(sock, cmd, &status) != 0)
+        {
+            fprintf(stderr, "connection to server lost\n");
+            return 1;
+        }
+        samples[i] = now_sec() - start;
+    }
+    close(sock);
+    report_latency("warm", samples, runs);
+
+    for (int i = 0; i < runs; i++)
+    {
+        double start = now_sec();
+        sock = server_connect(sock_path);
+        if (sock < 0 || server_request(sock, cmd, &status) != 0)
+        {
+            perror(sock_path);
+            return 1;
+        }
+        close(sock);
+        samples[i] = now_sec() - start;
+    }
+    report_latency("connect", samples, runs);
+
+    for (int i = 0; i < runs; i++)
+    {
+        double start = now_sec();
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            execl(shell, shell, "-c", cmd, (char *)NULL);
+            perror(shell);
+            _exit(127);
+        }
+        waitpid(pid, &status, 0);
+        samples[i] = now_sec() - start;
+    }
+    report_latency("cold", samples, runs);
+    free(samples);
+    return 0;
+}
+
+/*
+ * Xronos enos "SHELL args..." apo to fork mexri to waitpid
+ */
+static double time_shell(char *const args[])
+{
+    int status;
+    double start = now_sec();
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        execv(args[0], args);
+        perror(args[0]);
+        _exit(127);
+    }
+    waitpid(pid, &status, 0);
+    return now_sec() - start;
+}
+
+/*
+ * Startup me ena rc LINES grammwn (scalars kai ka8e 10h grammh array,
+ * ola me diaforetika onomata), ana ekkinhsh tou SHELL:
+ *   bare:    SHELL -c true, xwris rc
+ *   source:  SHELL -c 'source RC', to rc ginetai parse se ka8e ekkinhsh
+ *   restore: SHELL --restore SNAP -c true, to snapshot tou idiou rc
+ */
+static int bench_startup(const char *shell, int lines, int runs)
+{
+    char rc[64], snap[64], source_cmd[128], save_cmd[256];
+    snprintf(rc, sizeof(rc), "/tmp/hy345sh-bench-rc.%d", (int)getpid());
+    snprintf(snap, sizeof(snap), "/tmp/hy345sh-bench-snap.%d", (int)getpid());
+    FILE *f = fopen(rc, "w");
+    if (f == NULL)
+    {
+        perror(rc);
+        return 1;
+    }
+    for (int i = 0; i < lines; i++)
+    {
+        if (i % 10 == 9)
+        {
+            fprintf(f, "RC_ARR_%d=(alpha beta \"gamma %d\" delta)\n", i, i);
+        }
+        else
+        {
+            fprintf(f, "RC_VAR_%d=/usr/local/share/hy345sh/value/%d\n", i, i);
+        }
+    }
+    fclose(f);
+
+    snprintf(source_cmd, sizeof(source_cmd), "source %s", rc);
+    snprintf(save_cmd, sizeof(save_cmd), "source %s; snapshot save %s %s", rc, snap, rc);
+    char *save[] = {(char *)shell, "-c", save_cmd, NULL};
+    time_shell(save);
+
+    char *bare[] = {(char *)shell, "-c", "true", NULL};
+    char *cold[] = {(char *)shell, "-c", source_cmd, NULL};
+    char *restore[] = {(char *)shell, "--restore", snap, "-c", "true", NULL};
+    char *const *modes[] = {bare, cold, restore};
+    const char *names[] = {"bare", "source", "restore"};
+    double *samples = malloc(runs * sizeof(double));
+    printf("%-10s %13s %13s   (rc: %d lines)\n", "startup", "mean", "min", lines);
+    for (int m = 0; m < 3; m++)
+    {
+        for (int i = 0; i < runs; i++)
+        {
+            samples[i] = time_shell(modes[m]);
+        }
+        report_latency(names[m], samples, runs);
+    }
+    free(samples);
+    unlink(rc);
+    unlink(snap);
+    return 0;
+}
+
+/*
+ * Producer: grafei BYTES se bursts twn BURST bytes me PAUSE_US anamesa
+ * (opws enas decompressor pou vgazei ena block th fora)
+ */
+static int produce(const char *spec)
+{
+    char copy[128];
+    snprintf(copy, sizeof(copy), "%s", spec);
+    char *burst_s = strchr(copy, ':');
+    char *pause_s = burst_s != NULL ? strchr(burst_s + 1, ':') : NULL;
+    if (pause_s == NULL)
+    {
+        fprintf(stderr, "-G BYTES:BURST:PAUSE_US\n");
+        return 2;
+    }
+    *burst_s++ = '\0';
+    *pause_s++ = '\0';
+    long total = parse_size(copy), burst = parse_size(burst_s);
+    long pause = atol(pause_s);
+    static char block[65536];
+    memset(block, 'x', sizeof(block));
+    for (long sent = 0; sent < total;)
+    {
+        for (long b = 0; b < burst && sent < total;)
+        {
+            long n = burst - b < (long)sizeof(block) ? burst - b : (long)sizeof(block);
+            ssize_t w = write(STDOUT_FILENO, block, n);
+            if (w <= 0)
+            {
+                return 1;
+            }
+            b += w;
+            sent += w;
+        }
+        if (pause > 0)
+        {
+            usleep(pause);
+        }
+    }
+    return 0;
+}
+
+/*
+ * Consumer: diavazei kai kanei US_PER_64K us douleia (busy loop) ana 64 KB
+ */
+static int consume(long us_per_64k)
+{
+    static char block[65536];
+    long pending = 0;
+    ssize_t r;
+    while ((r = read(STDIN_FILENO, block, sizeof(block))) > 0)
+    {
+        pending += r;
+        while (pending >= (long)sizeof(block))
+        {
+            double until = now_sec() + us_per_64k / 1e6;
+            while (now_sec() < until)
+            {
+            }
+            pending -= sizeof(block);
+        }
+    }
+    return 0;
+}
+
+/*
+ * Throughput: o idios bursty producer / slow consumer me treis tropous
+ * Me default (64 KB) pipe o producer mplokarei sto burst kai o consumer
+ * meinei xwris dedomena sto pause, opote oi xronoi tous a8roizontai
+ */
+static void bench_throughput(const char *self, int runs)
+{
+    const char *workloads[][2] = {
+        {"bursty", "-G 64M:4M:20000 | %s -C 250"},
+        {"steady", "-G 256M:256M:0 | %s -C 0"},
+    };
+    const char *modes[] = {"", "PIPESIZE=1M ", "buffer 16M"};
+    printf("%-10s %-14s %10s %12s\n", "workload", "pipes", "time", "throughput");
+    for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++)
+    {
+        double mb = strcmp(workloads[w][0], "bursty") == 0 ? 64 : 256;
+        for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+        {
+            char tail[256], text[MAX_LINE];
+            snprintf(tail, sizeof(tail), workloads[w][1], self);
+            if (m == 2)
+            {
+                /* "-G ... | buffer 16M | self -C ..." */
+                char *bar = strchr(tail, '|');
+                *bar = '\0';
+                snprintf(text, sizeof(text), "%s %s| %s | %s", self, tail, modes[m], bar + 1);
+            }
+            else
+            {
+                snprintf(text, sizeof(text), "%s%s %s", modes[m], self, tail);
+            }
+            Node *node = parse_list(text);
+            double best = 0;
+            for (int r = 0; r < runs; r++)
+            {
+                double start = now_sec();
+                pipelining(node);
+                double elapsed = now_sec() - start;
+                if (r == 0 || elapsed < best)
+                {
+                    best = elapsed;
+                }
+            }
+            free_nodes(node);
+            printf("%-10s %-14s %7.0f ms %7.0f MB/s\n", workloads[w][0],
+                   m == 0 ? "default" : modes[m], best * 1e3, mb / best);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int lines = 10000;
+    double min_secs = 0.5;
+    int pipelines = 0;
+    int runs = 5;
+    const char *sock_path = NULL;
+    const char *shell = "./hy345sh";
+    const char *cmd = "true";
+    int throughput = 0;
+    int timeouts = 0;
+    int startup = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:t:pr:s:x:c:TWSG:C:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            lines = atoi(optarg);
+            break;
+        case 't':
+            min_secs = atof(optarg);
+            break;
+        case 'p':
+            pipelines = 1;
+            break;
+        case 'r':
+            runs = atoi(optarg);
+            break;
+        case 's':
+            sock_path = optarg;
+            break;
+        case 'x':
+            shell = optarg;
+            break;
+        case 'c':
+            cmd = optarg;
+            break;
+        case 'T':
+            throughput = 1;
+            break;
+        case 'W':
+            timeouts = 1;
+            break;
+        case 'S':
+            startup = 1;
+            break;
+        case 'G':
+            return produce(optarg);
+        case 'C':
+            return consume(atol(optarg));
+        default:
+            fprintf(stderr, "usage: %s [-n LINES] [-t SECONDS] | -p [-r RUNS] | -s SOCKET [-r RUNS] [-x SHELL] [-c CMD] | -T [-r RUNS] | -W [-r RUNS] | -S [-n LINES] [-r RUNS] [-x SHELL]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (sock_path != NULL)
+    {
+        return bench_server(sock_path, shell, cmd, runs > 0 ? runs : 1);
+    }
+    if (throughput)
+    {
+        bench_throughput(argv[0], runs > 0 ? runs : 1);
+        return 0;
+    }
+    if (startup)
+    {
+        return bench_startup(shell, lines > 0 ? lines : 1, runs > 0 ? runs : 1);
+    }
+    if (timeouts)
+    {
+        bench_timeout(runs > 0 ? runs : 1);
+        return 0;
+    }
+    if (pipelines)
+    {
+        bench_pipelines(runs > 0 ? runs : 1);
+        return 0;
+    }
+    if (lines <= 0)
+    {
+        lines = 1;
+    }
+
+    set_var("NAME", "George");
+    set_var("HOME_DIR", "/home/csd5127");
+    set_var("FILE_0", "a.txt");
+    set_var("FILE_1", "b.txt");
+    set_var("FILE_2", "c.txt");
+    set_var("FILE_3", "d.txt");
+    set_var("COUNT", "42");
+    set_var("GREETING", "Hello World");
+
+    const char *names[] = {"simple", "pipeline", "control", "vars"};
+    printf("%-10s %-9s %15s %17s\n", "bench", "corpus", "throughput", "latency");
+    for (size_t k = 0; k < sizeof(names) / sizeof(names[0]); k++)
+    {
+        Corpus c;
+        corpus_build(&c, names[k], lines);
+        bench_parse(&c, min_secs);
+        bench_expand(&c, min_secs);
+        bench_tokenize(&c, min_secs);
+        corpus_free(&c);
+    }
+    bench_prompt(NULL, min_secs);
+    bench_prompt("\\u@-5127-hy345sh:\\w$ ", min_secs);
+    bench_prompt("[\\u@\\h \\W \\?] \\t \\$ ", min_secs);
+    return 0;
+}
@@ -0,0 +1,534 @@
+/*
+ *  csd5127: George Kiosklis
+ *  cached builtin: content-addressed cache gia deterministic commands
+ *
+ *  cached [--hash] [--inputs f1 f2 ... --] [--vars V1 V2 ... --] [--] cmd args...
+ *  cached --stats | --clear
+ *
+ *  Ta options einai prin apo to cmd, me opoiadhpote seira; ka8e lista --inputs/--vars
+ *  kleinei me "--", kai ena sketo "--" teleiwnei ta options (gia cmd pou arxizei me "--")
+ *
+ *  To key einai hash apo: argv, cwd, ta values twn --vars, kai thn taftotita twn
+ *  --inputs (dev, inode, size, mtime h, me --hash, to periexomeno tous)
+ *  Se hit to stdout kai to exit status ginontai replay apo to store xwris ektelesh
+ *  Se miss to command ekteleitai, to stdout grafetai tautoxrona sto terminal kai sto store
+ *  To store einai ena directory me ena arxeio ana key; to mtime tou arxeiou einai h
+ *  teleftaia xrhsh, opote h LRU eviction svhnei ta palaiotera mexri to size cap
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "hy345sh.h"
+
+#define CACHE_MAGIC "HY3CACH1"
+#define CACHE_DEFAULT_MAX (64L * 1024 * 1024) /* default size cap tou store */
+
+/* header sthn arxh ka8e entry, meta akolou8ei to stdout */
+typedef struct
+{
+    char magic[8];
+    int32_t status;
+    uint32_t reserved;
+    uint64_t size;
+} CacheHeader;
+
+/*
+ * 128-bit key apo dyo anexarthta FNV-1a 64-bit hashes
+ */
+typedef struct
+{
+    uint64_t a;
+    uint64_t b;
+} CacheKey;
+
+static void key_init(CacheKey *k)
+{
+    k->a = 14695981039346656037ULL;
+    k->b = 0x6a09e667f3bcc909ULL;
+}
+
+static void key_add(CacheKey *k, const void *data, size_t n)
+{
+    const unsigned char *p = data;
+    for (size_t i = 0; i < n; i++)
+    {
+        k->a = (k->a ^ p[i]) * 1099511628211ULL;
+        k->b = (k->b ^ p[i]) * 0x100000001b3ULL;
+        k->b ^= k->b >> 29;
+    }
+}
+
+/* prosthetei ena string mazi me to '\0', wste ("ab","c") != ("a","bc") */
+static void key_add_str(CacheKey *k, const char *s)
+{
+    key_add(k, s, strlen(s) + 1);
+}
+
+/*
+ * Prosthetei thn taftotita enos input file sto key
+ * Returns: 0 se epityxia, -1 an to arxeio den diavazetai
+ */
+static int key_add_file(CacheKey *k, const char *path, int by_content)
+{
+    struct stat sb;
+    key_add_str(k, path);
+    if (stat(path, &sb) != 0)
+    {
+        key_add_str(k, "<missing>");
+        return 0;
+    }
+    if (!by_content)
+    {
+        key_add(k, &sb.st_dev, sizeof(sb.st_dev));
+        key_add(k, &sb.st_ino, sizeof(sb.st_ino));
+        key_add(k, &sb.st_size, sizeof(sb.st_size));
+        key_add(k, &sb.st_mtim, sizeof(sb.st_mtim));
+        return 0;
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        perror(path);
+        return -1;
+    }
+    char buf[65536];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0)
+    {
+        key_add(k, buf, n);
+    }
+    close(fd);
+    return n < 0 ? -1 : 0;
+}
+
+/*
+ * To directory tou store: $HY345SH_CACHE_DIR, alliws $HOME/.cache/hy345sh
+ * To dhmiourgei an den yparxei
+ */
+static const char *cache_dir(void)
+{
+    static char dir[MAX_LINE];
+    const char *env = getenv("HY345SH_CACHE_DIR");
+    if (env != NULL && *env != '\0')
+    {
+        snprintf(dir, sizeof(dir), "%s", env);
+    }
+    else if (getenv("HOME") != NULL)
+    {
+        snprintf(dir, sizeof(dir), "%s/.cache", getenv("HOME"));
+        mkdir(dir, 0755);
+        strncat(dir, "/hy345sh", sizeof(dir) - strlen(dir) - 1);
+    }
+    else
+    {
+        snprintf(dir, sizeof(dir), "/tmp/hy345sh-cache-%d", (int)getuid());
+    }
+    mkdir(dir, 0755);
+    return dir;
+}
+
+/* size cap tou store se bytes ($HY345SH_CACHE_MAX) */
+static long cache_max_bytes(void)
+{
+    const char *env = getenv("HY345SH_CACHE_MAX");
+    long max = env != NULL ? atol(env) : 0;
+    return max > 0 ? max : CACHE_DEFAULT_MAX;
+}
+
+static int write_all(int fd, const char *buf, size_t n)
+{
+    while (n > 0)
+    {
+        ssize_t w = write(fd, buf, n);
+        if (w < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        buf += w;
+        n -= w;
+    }
+    return 0;
+}
+
+/*
+ * Hit: antigrafei to stdout tou entry sto fd 1 kai anane8ei to mtime (LRU)
+ * To megethos tou arxeiou elegxetai prin grafei tipota: ena entry me xalasmeno
+ * header h me body pio mikro/megalo apo to h.size svhnetai kai metraei san miss
+ * Returns: to apo8hkeymeno exit status, -1 an to entry leipei h einai xalasmeno
+ */
+static int cache_replay(const char *path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    CacheHeader h;
+    struct stat sb;
+    if (read(fd, &h, sizeof(h)) != (ssize_t)sizeof(h) || memcmp(h.magic, CACHE_MAGIC, 8) != 0 ||
+        fstat(fd, &sb) != 0 || (uint64_t)sb.st_size != sizeof(h) + h.size)
+    {
+        close(fd);
+        unlink(path);
+        return -1;
+    }
+    char buf[65536];
+    uint64_t left = h.size;
+    while (left > 0)
+    {
+        ssize_t n = read(fd, buf, left < sizeof(buf) ? left : sizeof(buf));
+        if (n <= 0 || write_all(STDOUT_FILENO, buf, n) != 0)
+        {
+            break;
+        }
+        left -= n;
+    }
+    close(fd);
+    utimensat(AT_FDCWD, path, NULL, 0);
+    return h.status;
+}
+
+/*
+ * LRU eviction: an to store xeperna to cap, svhnei ta entries me to palaiotero mtime
+ */
+typedef struct
+{
+    char name[64];
+    struct timespec used;
+    off_t size;
+} CacheEntry;
+
+static int entry_cmp(const void *x, const void *y)
+{
+    const CacheEntry *a = x, *b = y;
+    if (a->used.tv_sec != b->used.tv_sec)
+    {
+        return a->used.tv_sec < b->used.tv_sec ? -1 : 1;
+    }
+    return a->used.tv_nsec < b->used.tv_nsec ? -1 : (a->used.tv_nsec > b->used.tv_nsec);
+}
+
+/*
+ * Diavazei ta entries tou store
+ * Returns: pinakas (free apo ton caller), to plh8os sto *count kai to synoliko size sto *total
+ */
+static CacheEntry *cache_scan(const char *dir, int *count, long *total)
+{
+    int cap = 64;
+    CacheEntry *entries = malloc(cap * sizeof(CacheEntry));
+    *count = 0;
+    *total = 0;
+    DIR *d = opendir(dir);
+    if (d == NULL)
+    {
+        return entries;
+    }
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL)
+    {
+        size_t len = strlen(de->d_name);
+        struct stat sb;
+        if (len < 5 || len >= sizeof(entries[0].name) || strcmp(de->d_name + len - 4, ".out") != 0)
+        {
+            continue;
+        }
+        if (fstatat(dirfd(d), de->d_name, &sb, 0) != 0)
+        {
+            continue;
+        }
+        if (*count == cap)
+        {
+            cap *= 2;
+            entries = realloc(entries, cap * sizeof(CacheEntry));
+        }
+        strcpy(entries[*count].name, de->d_name);
+        entries[*count].used = sb.st_mtim;
+        entries[*count].size = sb.st_size;
+        *total += sb.st_size;
+        (*count)++;
+    }
+    closedir(d);
+    return entries;
+}
+
+static void cache_evict(const char *dir)
+{
+    int count;
+    long total;
+    long max = cache_max_bytes();
+    CacheEntry *entries = cache_scan(dir, &count, &total);
+    if (total > max)
+    {
+        qsort(entries, count, sizeof(CacheEntry), entry_cmp);
+        for (int i = 0; i < count && total > max; i++)
+        {
+            char path[MAX_LINE + 64];
+            snprintf(path, sizeof(path), "%s/%s", dir, entries[i].name);
+            if (unlink(path) == 0)
+            {
+                total -= entries[i].size;
+                STAT_INC(cache_evictions);
+            }
+        }
+    }
+    free(entries);
+}
+
+/*
+ * Miss: ekteleitai to command me to stdout se pipe, kai o parent to grafei
+ * sto fd 1 kai sto entry. To entry ginetai rename sth 8esh tou mono an to
+ * command teleiwse kanonika (oxi apo signal, oxi exec failure)
+ * Returns: to exit status tou command
+ */
+static int cache_run(char **argv, const char *dir, const char *path)
+{
+    int p[2];
+    if (pipe2(p, O_CLOEXEC) < 0)
+    {
+        perror("pipe");
+        return 1;
+    }
+    reader_sync_all();
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        close(p[0]);
+        close(p[1]);
+        return 1;
+    }
+    if (pid == 0)
+    {
+        dup2(p[1], STDOUT_FILENO);
+        if (TRACE_ON) trace_exec(0, argv);
+        exec_path(argv);
+        perror("execvp");
+        _exit(127);
+    }
+    close(p[1]);
+    STAT_INC(forks);
+    if (TRACE_ON) trace_fork(pid, 0, argv);
+
+    char tmp[MAX_LINE + 64];
+    snprintf(tmp, sizeof(tmp), "%s/.tmp.%d", dir, (int)getpid());
+    int out = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    CacheHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, CACHE_MAGIC, 8);
+    if (out >= 0 && write_all(out, (const char *)&h, sizeof(h)) != 0)
+    {
+        close(out);
+        out = -1;
+    }
+
+    char buf[65536];
+    ssize_t n;
+    while ((n = read(p[0], buf, sizeof(buf))) != 0)
+    {
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        write_all(STDOUT_FILENO, buf, n);
+        if (out >= 0 && write_all(out, buf, n) != 0)
+        {
+            close(out);
+            out = -1;
+        }
+        h.size += n;
+    }
+    close(p[0]);
+
+    int status;
+    wait_for(pid, &status);
+    if (TRACE_ON) trace_exit(pid, 0, argv, status);
+    int code = status_code(status);
+
+    if (out >= 0)
+    {
+        int ok = WIFEXITED(status) && code != 127;
+        h.status = code;
+        ok = ok && pwrite(out, &h, sizeof(h), 0) == (ssize_t)sizeof(h);
+        close(out);
+        if (ok && rename(tmp, path) == 0)
+        {
+            STAT_INC(cache_stores);
+            cache_evict(dir);
+        }
+        else
+        {
+            unlink(tmp);
+        }
+    }
+    return code;
+}
+
+/*
+ * Oi counters einai sto shared stats page (shstat), opote metrane kai ta
+ * cached pou etrexan san pipeline stage se child
+ */
+static void cache_stats(void)
+{
+    int count;
+    long total;
+    const char *dir = cache_dir();
+    CacheEntry *entries = cache_scan(dir, &count, &total);
+    free(entries);
+    unsigned long long hits = __atomic_load_n(&shstat->cache_hits, __ATOMIC_RELAXED);
+    unsigned long long misses = __atomic_load_n(&shstat->cache_misses, __ATOMIC_RELAXED);
+    printf("cache: %s\n", dir);
+    printf("entries: %d (%ld bytes, cap %ld)\n", count, total, cache_max_bytes());
+    printf("hits: %llu misses: %llu hit ratio: %.1f%%\n", hits, misses,
+           hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0.0);
+    printf("stores: %llu evictions: %llu\n",
+           (unsigned long long)__atomic_load_n(&shstat->cache_stores, __ATOMIC_RELAXED),
+           (unsigned long long)__atomic_load_n(&shstat->cache_evictions, __ATOMIC_RELAXED));
+}
+
+static void cache_clear(void)
+{
+    int count;
+    long total;
+    const char *dir = cache_dir();
+    CacheEntry *entries = cache_scan(dir, &count, &total);
+    for (int i = 0; i < count; i++)
+    {
+        char path[MAX_LINE + 64];
+        snprintf(path, sizeof(path), "%s/%s", dir, entries[i].name);
+        unlink(path);
+    }
+    free(entries);
+}
+
+/*
+ * To cached builtin (argv[0] == "cached")
+ * Returns: to exit status tou command (apo to store h apo thn ektelesh)
+ */
+int builtin_cached(int argc, char **argv)
+{
+    CacheKey key;
+    int by_content = 0;
+    int i = 1;
+    key_init(&key);
+
+    if (argc == 2 && strcmp(argv[1], "--stats") == 0)
+    {
+        cache_stats();
+        return 0;
+    }
+    if (argc == 2 && strcmp(argv[1], "--clear") == 0)
+    {
+        cache_clear();
+        return 0;
+    }
+
+    /* ta options prin apo to command; ta --inputs/--vars mazevoun mexri to "--" */
+    int inputs_at = -1, vars_at = -1;
+    while (i < argc && strncmp(argv[i], "--", 2) == 0)
+    {
+        if (argv[i][2] == '\0')
+        {
+            i++;
+            break;
+        }
+        if (strcmp(argv[i], "--hash") == 0)
+        {
+            by_content = 1;
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--inputs") != 0 && strcmp(argv[i], "--vars") != 0)
+        {
+            fprintf(stderr, "cached: unknown option %s\n", argv[i]);
+            return 2;
+        }
+        if (argv[i][2] == 'i')
+        {
+            inputs_at = i + 1;
+        }
+        else
+        {
+            vars_at = i + 1;
+        }
+        for (i++; i < argc && strcmp(argv[i], "--") != 0; i++)
+        {
+        }
+        if (i == argc)
+        {
+            fprintf(stderr, "cached: missing '--' after file/variable list\n");
+            return 2;
+        }
+        i++;
+    }
+    if (i >= argc)
+    {
+        fprintf(stderr, "usage: cached [--hash] [--inputs FILE... --] [--vars VAR... --] [--] cmd args...\n"
+                        "       cached --stats | --clear\n");
+        return 2;
+    }
+
+    char cwd[MAX_LINE];
+    key_add_str(&key, getcwd(cwd, sizeof(cwd)) != NULL ? cwd : "");
+    for (int j = i; j < argc; j++)
+    {
+        key_add_str(&key, argv[j]);
+    }
+    key_add_str(&key, "<vars>");
+    for (int j = vars_at; j >= 0 && j < argc && strcmp(argv[j], "--") != 0; j++)
+    {
+        Var *arr = get_array(argv[j]);
+        if (arr != NULL)
+        {
+            key_add_str(&key, argv[j]);
+            key_add(&key, arr->elems.data, arr->elems.len);
+            continue;
+        }
+        const char *val = get_Var(argv[j]);
+        if (val == NULL)
+        {
+            val = getenv(argv[j]);
+        }
+        key_add_str(&key, argv[j]);
+        key_add_str(&key, val != NULL ? val : "<unset>");
+    }
+    key_add_str(&key, by_content ? "<content>" : "<stat>");
+    for (int j = inputs_at; j >= 0 && j < argc && strcmp(argv[j], "--") != 0; j++)
+    {
+        if (key_add_file(&key, argv[j], by_content) != 0)
+        {
+            return 1;
+        }
+    }
+
+    const char *dir = cache_dir();
+    char path[MAX_LINE + 64];
+    snprintf(path, sizeof(path), "%s/%016llx%016llx.out", dir,
+             (unsigned long long)key.a, (unsigned long long)key.b);
+
+    fflush(stdout); /* to output tou cache grafetai kateu8eian sto fd 1 */
+    int status = cache_replay(path);
+    if (status >= 0)
+    {
+        STAT_INC(cache_hits);
+        return status;
+    }
+    STAT_INC(cache_misses);
+    return cache_run(argv + i, dir, path);
+}
@@ -0,0 +1,1034 @@
+/*
+ *  csd5127: George Kiosklis
+ *  Ektelesh tou syntax tree: builtins, external commands, pipelines, if/for
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <termios.h>
+#include <sys/wait.h>
+#include <sys/types.h>
+
+#include "hy345sh.h"
+
+/* Track exit status of last command for if statement conditions */
+int last_exit_status = 0;
+
+/* 0 gia -c kai script mode (to main to allazei) */
+int shell_interactive = 1;
+
+/*
+ * Efarmogh twn redirections (<, >, >>) sto trexon process
+ * Returns: 0 se epityxia, -1 an den anoixe kapoio arxeio
+ */
+static int apply_redirections(const SimpleCmd *c)
+{
+    /* input redirection */
+    if (c->input_file!=NULL)
+    {
+        int fd=open(c->input_file, O_RDONLY);
+        if (fd < 0)
+        {
+            perror("open input");
+            return -1;
+        }
+        reader_forget(STDIN_FILENO); /* to lookahead tou paliou stdin den isxyei pia */
+        dup2(fd, STDIN_FILENO);
+        close(fd);
+    }
+
+    /* output redirection */
+    if (c->output_file!=NULL)
+    {
+        int flags=O_WRONLY | O_CREAT;
+        flags|=c->append ? O_APPEND : O_TRUNC;
+        int fd=open(c->output_file, flags, 0644);
+        if (fd < 0)
+        {
+            perror("open output");
+            return -1;
+        }
+        dup2(fd, STDOUT_FILENO);
+        close(fd);
+    }
+    return 0;
+}
+
+/*
+ * Efarmogh twn redirections sto child prin to execvp
+ */
+static void redirect_child(const SimpleCmd *c)
+{
+    if (apply_redirections(c) != 0)
+    {
+        exit(1);
+    }
+}
+
+/*
+ * Redirections gia builtin h block pou trexei mesa sto shell (p.x. cached > out.txt,
+ * while ...; done < file): to push kratha ta stdin/stdout me dup kai efarmozei ta
+ * redirections, to pop ta epanaferei. saved[0]/saved[1] einai -1 an den allaxe tipota
+ * O Reader (lookahead) tou stdin metaferetai mazi me to fd, opote den xanetai
+ * Returns: 0 se epityxia, -1 an den anoixe kapoio arxeio (to pop xreiazetai kai tote)
+ */
+static int push_redirections(const SimpleCmd *c, int saved[2])
+{
+    saved[0] = c->input_file != NULL ? fcntl(STDIN_FILENO, F_DUPFD_CLOEXEC, 10) : -1;
+    if (saved[0] >= 0)
+    {
+        reader_move(STDIN_FILENO, saved[0]);
+    }
+    if (c->output_file != NULL)
+    {
+        fflush(stdout);
+        saved[1] = fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 10);
+    }
+    else
+    {
+        saved[1] = -1;
+    }
+    return apply_redirections(c);
+}
+
+static void pop_redirections(int saved[2])
+{
+    for (int fd = 0; fd < 2; fd++)
+    {
+        if (saved[fd] >= 0)
+        {
+            if (fd == STDOUT_FILENO)
+            {
+                fflush(stdout);
+            }
+            dup2(saved[fd], fd);
+            if (fd == STDIN_FILENO)
+            {
+                reader_move(saved[fd], fd);
+            }
+            close(saved[fd]);
+        }
+    }
+}
+
+/*
+ * Tail-exec: to teleftaio command enos non-interactive run antikathista to shell
+ * anti gia fork + wait. Den ginetai otan to shell exei akoma douleia meta to command:
+ * to tracing prepei na grapsei to exit event (traps kai background jobs den yparxoun)
+ */
+static int can_tail_exec(void)
+{
+    return !shell_interactive && !TRACE_ON;
+}
+
+/*
+ * Antikathista to shell process me to command (exec builtin kai tail-exec)
+ * Epistrefei mono an to execvp apotyxei
+ */
+static void exec_replace(const SimpleCmd *c)
+{
+    fflush(NULL); /* ta stdio buffers xanontai sto execvp */
+    reader_sync_all();
+    if (TRACE_ON)
+    {
+        trace_exec(0, (char **)c->argv);
+        trace_stop();
+    }
+    exec_path((char **)c->argv);
+    perror("execvp");
+}
+
+/*
+ * exec [cmd args...] [redirections]
+ * Me command: to shell ginetai to command (xwris fork)
+ * Xwris command: ta redirections efarmozontai monima sto idio to shell
+ */
+static void builtin_exec(SimpleCmd *c)
+{
+    if (apply_redirections(c) != 0)
+    {
+        last_exit_status = 1;
+        if (!shell_interactive)
+        {
+            exit(1);
+        }
+        return;
+    }
+    if (c->argc < 2)
+    {
+        last_exit_status = 0;
+        return;
+    }
+    SimpleCmd target = *c;
+    for (int i = 1; i <= c->argc; i++)
+    {
+        target.argv[i - 1] = c->argv[i];
+    }
+    target.argc = c->argc - 1;
+    exec_replace(&target);
+    last_exit_status = 127;
+    if (!shell_interactive)
+    {
+        exit(127);
+    }
+}
+
+/*
+ * Variable assignment: name=value h name="value with spaces",
+ * name=(w1 w2 ...) gia array kai name+=... gia append
+ */
+static void assign_var(const char *cmd)
+{
+    char *copy=my_strdup(cmd);
+    char *eq=strchr(copy, '=');
+    *eq='\0';
+    char *name=copy;
+    char *val=eq + 1;
+
+    /* afairei ta spaces gia to name */
+    while (*name == ' ' || *name == '\t')
+        name++;
+
+    int append = 0;
+    size_t name_len = strlen(name);
+    if (name_len > 1 && name[name_len - 1] == '+')
+    {
+        name[name_len - 1] = '\0';
+        append = 1;
+    }
+
+    /* afairei ta trailing spaces (p.x. "a=(x y) ") */
+    size_t len=strlen(val);
+    while (len > 0 && (val[len - 1] == ' ' || val[len - 1] == '\t'))
+    {
+        val[--len] = '\0';
+    }
+
+    if (len > 1 && val[0] == '(' && val[len - 1] == ')')
+    {
+        val[len - 1] = '\0';
+        assign_array(name, val + 1, append);
+        last_exit_status = 0;
+        free(copy);
+        return;
+    }
+
+    /* afairei quotes an yparxoun */
+    if (len > 1 && val[0] == '"' && val[len - 1] == '"')
+    {
+        val[len - 1]='\0';
+        val++;
+    }
+
+    if (append)
+    {
+        char joined[MAX_VAR_VALUE];
+        const char *old = get_Var(name);
+        snprintf(joined, sizeof(joined), "%s%s", old != NULL ? old : "", val);
+        set_var(name, joined);
+    }
+    else
+    {
+        set_var(name, val);
+    }
+    last_exit_status = 0; /* Assignment always succeeds */
+    free(copy);
+}
+
+/*
+ * Ta builtins tou execute_cmd (gia to builtin/external ratio tou shstat)
+ */
+static int is_builtin(const char *name)
+{
+    static const char *names[] = {"cd", "read", "trace", "cached", "shstat", "source", "snapshot", "exec", "exit"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        if (strcmp(name, names[i]) == 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Executes a single command
+ * Handles: Variable assignments (VAR=value), Variable expansion ($VAR), I/O redirection (<, >, >>),
+ * Built-in commands (cd, read, exit, trace, cached, shstat, source, snapshot, exec), External commands via fork/exec
+ * Me EXEC_TAIL (kai can_tail_exec()) to external command kanei exec xwris fork
+ */
+void execute_cmd(const char *cmd, int flags)
+{
+    SimpleCmd c;
+
+    /* Kanei check gia variable assignment (x=value or x="value with spaces") */
+    if (!(flags & EXEC_STAGE))
+    {
+        STAT_INC(commands);
+    }
+    if (is_assignment(cmd))
+    {
+        STAT_INC(assignments);
+        assign_var(cmd);
+        return; /* Exit afotou kanei set to variable */
+    }
+
+    char expanded[MAX_LINE];
+    strncpy(expanded, var_expansion(cmd), MAX_LINE - 1);
+    expanded[MAX_LINE - 1]='\0';
+    tokenize_cmd(expanded, &c);
+
+    char **args=c.argv;
+    int argc=c.argc;
+    if (argc==0) return;
+    if (is_builtin(args[0]))
+    {
+        STAT_INC(builtins);
+    }
+    else
+    {
+        STAT_INC(externals);
+    }
+    if (strcmp(args[0], "cd") == 0)
+    {
+        if (argc > 1)
+        {
+            if (chdir(args[1]) != 0)
+            {
+                perror("cd");
+            }
+            prompt_cwd_changed();
+        }
+        else
+        {
+            char *home=getenv("HOME");
+            if (home==NULL)
+            {
+                fprintf(stderr, "cd: HOME not set\n");
+            }
+            else
+            {
+                if (chdir(home) != 0)
+                {
+                    perror("cd");
+                }
+                prompt_cwd_changed();
+            }
+        }
+        return;
+    }
+
+    /* read [-r] [-d delim] var...: mesa apo ton Reader tou stdin (vl. input.c) */
+    if (strcmp(args[0], "read") == 0)
+    {
+        int saved[2];
+        if (push_redirections(&c, saved) == 0)
+        {
+            last_exit_status = builtin_read(argc, args);
+        }
+        else
+        {
+            last_exit_status = 1;
+        }
+        pop_redirections(saved);
+        return;
+    }
+
+    /* trace FILE | trace off: Chrome trace-event JSON tracing */
+    if (strcmp(args[0], "trace") == 0)
+    {
+        if (argc < 2)
+        {
+            printf("trace: %s\n", TRACE_ON ? "on" : "off");
+        }
+        else if (strcmp(args[1], "off") == 0)
+        {
+            trace_stop();
+        }
+        else if (trace_start(args[1]) != 0)
+        {
+            perror("trace");
+            last_exit_status = 1;
+            return;
+        }
+        last_exit_status = 0;
+        return;
+    }
+
+    /* cached cmd: replay tou stdout/status apo to result cache (vl. cache.c) */
+    if (strcmp(args[0], "cached") == 0)
+    {
+        int saved[2];
+        if (push_redirections(&c, saved) == 0)
+        {
+            last_exit_status = builtin_cached(argc, args);
+        }
+        else
+        {
+            last_exit_status = 1;
+        }
+        pop_redirections(saved);
+        return;
+    }
+
+    /* shstat [-j]: runtime counters (vl. stats.c) */
+    if (strcmp(args[0], "shstat") == 0)
+    {
+        int saved[2];
+        if (push_redirections(&c, saved) == 0)
+        {
+            last_exit_status = builtin_shstat(argc, args);
+        }
+        else
+        {
+            last_exit_status = 1;
+        }
+        pop_redirections(saved);
+        return;
+    }
+
+    /* source FILE kai snapshot save FILE [RCFILE] (vl. snapshot.c) */
+    if (strcmp(args[0], "source") == 0 || strcmp(args[0], "snapshot") == 0)
+    {
+        int saved[2];
+        if (push_redirections(&c, saved) == 0)
+        {
+            last_exit_status = args[0][1] == 'o' ? builtin_source(argc, args) : builtin_snapshot(argc, args);
+        }
+        else
+        {
+            last_exit_status = 1;
+        }
+        pop_redirections(saved);
+        return;
+    }
+
+    /* exec cmd: antikathista to shell */
+    if (strcmp(args[0], "exec") == 0)
+    {
+        builtin_exec(&c);
+        return;
+    }
+
+    /* Exit shell */
+    if (strcmp(args[0], "exit") == 0)
+    {
+        trace_stop();
+        if (shell_interactive)
+        {
+            printf("Terminating shell...\n");
+            printf("Goodbye!\n");
+        }
+        exit(argc > 1 ? atoi(args[1]) : (shell_interactive ? 0 : last_exit_status));
+    }
+
+    /* Tail-exec: den yparxei tipota meta apo afto to command, ara xwris fork */
+    if ((flags & EXEC_TAIL) && can_tail_exec())
+    {
+        redirect_child(&c);
+        exec_replace(&c);
+        exit(1);
+    }
+
+    /* External command: fork and exec */
+    path_lookup(args[0]); /* sto cache tou parent, oxi tou child pou 8a xa8ei */
+    reader_sync_all();    /* to child synexizei to stdin apo ekei pou emeine to read */
+    pid_t pid = fork();
+
+    if (pid < 0)
+    {
+        perror("fork");
+        return;
+    }
+    else if (pid == 0)
+    {
+        /* Child process */
+        redirect_child(&c);
+
+        if (TRACE_ON) trace_exec(0, args);
+        exec_path(args);
+        if (TRACE_ON) trace_proc("exec_error", getpid(), 0, args[0], errno);
+        perror("execvp");
+        exit(1);
+    }
+    else
+    {
+        /* Parent process */
+        int status;
+        STAT_INC(forks);
+        if (TRACE_ON) trace_fork(pid, 0, args);
+        wait_for(pid, &status);
+        if (TRACE_ON) trace_exit(pid, 0, args, status);
+        if (WIFEXITED(status)) {
+            last_exit_status = WEXITSTATUS(status);
+        }
+    }
+}
+
+
+
+/*
+ * Job control: mono gia interactive shell pou einai to foreground process group
+ * tou terminal. Tote ka8e pipeline mpainei se diko tou process group kai pairnei
+ * to terminal. Alliws (-c, script, stdin apo pipe) ta stages menoun sto group
+ * tou shell: ena group xwris to terminal 8a epairne SIGTTIN diavazontas apo to
+ * tty, kai to Ctrl-C 8a eftane mono sto shell
+ * Ena pipeline me timeout exei panta diko tou group, wste to deadline na ftasei
+ * kai sta processes pou xekinane ta stages. Xwris job control den pairnei to
+ * terminal (opws to GNU timeout) kai ta signals tou shell proow8ountai se afto
+ */
+static int terminal_owner = -1;
+
+static int job_control(void)
+{
+    if (terminal_owner < 0)
+    {
+        terminal_owner = shell_interactive && isatty(STDIN_FILENO) && tcgetpgrp(STDIN_FILENO) == getpgrp();
+    }
+    return terminal_owner;
+}
+
+/*
+ * Dinei to terminal sto process group pgid (kai to pairnei pisw me pgid = getpgrp())
+ */
+static void give_terminal(pid_t pgid)
+{
+    if (!job_control())
+    {
+        return;
+    }
+    /* to shell den einai foreground otan pairnei pisw to terminal, ara agnoei to SIGTTOU */
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGTTOU);
+    sigprocmask(SIG_BLOCK, &block, &old);
+    tcsetpgrp(STDIN_FILENO, pgid);
+    sigprocmask(SIG_SETMASK, &old, NULL);
+}
+
+/*
+ * Signal forwarding gia ena timeout pipeline xwris job control: to Ctrl-C (kai
+ * ena kill sto shell) ftanei mono sto group tou shell. Oso to shell perimenei,
+ * ta signals pou 8a to termatizan (SIG_DFL) stelnontai kai sto group tou
+ * pipeline, kai meta to wait to shell termatizetai apo to idio signal
+ */
+static const int forward_sigs[] = {SIGHUP, SIGINT, SIGQUIT, SIGTERM};
+#define FORWARD_SIGS (int)(sizeof(forward_sigs) / sizeof(forward_sigs[0]))
+static volatile sig_atomic_t forward_pgid = 0;
+static volatile sig_atomic_t forwarded_sig = 0;
+
+static void forward_signal(int sig)
+{
+    forwarded_sig = sig;
+    kill(-forward_pgid, sig);
+}
+
+static void forward_start(pid_t pgid, struct sigaction *saved)
+{
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sa.sa_handler = forward_signal;
+    forward_pgid = pgid;
+    forwarded_sig = 0;
+    for (int i = 0; i < FORWARD_SIGS; i++)
+    {
+        sigaction(forward_sigs[i], NULL, &saved[i]);
+        if (saved[i].sa_handler == SIG_DFL)
+        {
+            sigaction(forward_sigs[i], &sa, NULL);
+        }
+    }
+}
+
+static void forward_stop(const struct sigaction *saved)
+{
+    for (int i = 0; i < FORWARD_SIGS; i++)
+    {
+        sigaction(forward_sigs[i], &saved[i], NULL);
+    }
+    if (forwarded_sig != 0)
+    {
+        fflush(NULL);
+        raise(forwarded_sig);
+    }
+}
+
+/*
+ * Ektelesh enos pipeline stage sto child (meta ta dup2 twn pipes)
+ * out_private: to stdout einai pipe tou idiou pipeline (oxi tou shell)
+ * Ena block stage ({ }, ( ), if, for, while) h ena builtin (p.x. cached, shstat,
+ * read) trexei mesa sto child, pou einai pleon ena non-interactive shell gia to
+ * stage (exit kai tail-exec douleyoun)
+ * To child metraei an to stage htan builtin h external (to command to metrhse o parent)
+ * Den epistrefei pote
+ */
+static void exec_stage(Node *stage, int i, int out_private)
+{
+    if (stage->type != NODE_CMD)
+    {
+        shell_interactive = 0;
+        terminal_owner = 0; /* to terminal anhkei sto shell, oxi sta nested pipelines tou stage */
+        exec_nodes(stage, EXEC_TAIL);
+        fflush(NULL);
+        exit(last_exit_status);
+    }
+
+    /* parse and execute to command me ta redirections tou*/
+    SimpleCmd c;
+    char expanded_cmd[MAX_LINE];
+    strncpy(expanded_cmd, var_expansion(stage->text), MAX_LINE - 1);
+    expanded_cmd[MAX_LINE - 1] = '\0';
+    tokenize_cmd(expanded_cmd, &c);
+    if (c.argc > 0 && is_builtin(c.argv[0]))
+    {
+        shell_interactive = 0;
+        terminal_owner = 0;
+        execute_cmd(stage->text, EXEC_TAIL | EXEC_STAGE);
+        fflush(NULL);
+        exit(last_exit_status);
+    }
+    redirect_child(&c);
+
+    /* buffer SIZE: to ring buffer tou pipebuf.c anti gia external process */
+    if (c.argc > 0 && strcmp(c.argv[0], "buffer") == 0)
+    {
+        STAT_INC(builtins);
+        long size = c.argc == 2 ? parse_size(c.argv[1]) : -1;
+        if (size <= 0)
+        {
+            fprintf(stderr, "usage: buffer SIZE (p.x. buffer 64M)\n");
+            exit(2);
+        }
+        exit(buffer_run(size, out_private && c.output_file == NULL));
+    }
+
+    /* Execute command */
+    if (c.argc > 0)
+    {
+        STAT_INC(externals);
+        if (TRACE_ON) trace_exec(i, c.argv);
+        exec_path(c.argv);
+        if (TRACE_ON) trace_proc("exec_error", getpid(), i, c.argv[0], errno);
+        perror("execvp");
+    }
+    exit(1);
+}
+
+/*
+ * xirismos twn command pipelines p.x. (cmd1 | cmd2 | cmd3 | ...)
+ * Ta pipes ftiaxnontai lazily, ena gia ka8e zeugari diadoxikwn stages, me O_CLOEXEC:
+ * to child kanei dup2 mono ta dika tou akra kai ta ypoloipa kleinoun sto execvp,
+ * kai o parent krataei to poly ena read end anoixto, ara O(n) syscalls gia n stages
+ * kai kanena orio sta stages
+ * Me job control h me timeout ola ta stages mpainoun sto idio process group
+ * (to pid tou prwtou stage), alliws menoun sto group tou shell (vl. job_control)
+ * O parent perimenei ta pids pou katagrafei
+ * To status tou ka8e stage mpainei sto PIPESTATUS array (${PIPESTATUS[i]}), to
+ * last_exit_status einai tou teleftaiou
+ * Me PIPESIZE ta pipes megalwnoun me F_SETPIPE_SZ (vl. pipebuf.c)
+ * Me timeout prefix to wait exei deadline gia ola ta stages (vl. wait.c),
+ * kai tote kai ena mono stage trexei se diko tou child
+ */
+void pipelining(Node *pipeline)
+{
+    int cmd_c=pipeline->nstages;
+
+    if (cmd_c == 0)
+    {
+        return;
+    }
+    /* xwris timeout ena stage einai aplo command (builtins mesa sto shell) */
+    WaitDeadline deadline;
+    if (pipeline->timeout != NULL)
+    {
+        char options[MAX_LINE];
+        strncpy(options, var_expansion(pipeline->timeout), MAX_LINE - 1);
+        options[MAX_LINE - 1] = '\0';
+        if (timeout_parse(options, &deadline) != 0)
+        {
+            last_exit_status = 125;
+            return;
+        }
+    }
+    else if (cmd_c == 1)
+    {
+        exec_nodes(pipeline->stages[0], 0);
+        return;
+    }
+
+    STAT_INC(pipelines);
+    reader_sync_all();
+    fflush(NULL); /* ta block stages kanoun exit() sto child */
+    long pipe_size=pipe_size_for(pipeline); /* 0: default tou kernel */
+    pid_t *pids=malloc(cmd_c * sizeof(pid_t));
+    int started=0;
+    int prev_read=-1; /* read end tou pipe apo to prohgoumeno stage */
+    pid_t pgid=0; /* 0: ta stages menoun sto group tou shell */
+    int own_group=job_control() || pipeline->timeout != NULL;
+    for (int i = 0; i < cmd_c; i++)
+    {
+        int p[2] = {-1, -1};
+        if (i < cmd_c - 1)
+        {
+            if (pipe2(p, O_CLOEXEC) < 0)
+            {
+                perror("pipe");
+                break;
+            }
+            pipe_set_size(p[1], pipe_size);
+        }
+
+        pid_t pid=fork();
+        if (pid < 0)
+        {
+            perror("fork");
+            if (p[0] >= 0)
+            {
+                close(p[0]);
+                close(p[1]);
+            }
+            break;
+        }
+        else if (pid == 0)
+        {
+            /* Child process */
+            stats_forked();
+            if (own_group)
+            {
+                setpgid(0, pgid);
+            }
+
+            /* Redirect input apo prohgoumeno pipe */
+            if (prev_read >= 0)
+            {
+                dup2(prev_read, STDIN_FILENO);
+                reader_forget(STDIN_FILENO); /* to buffer tou stdin tou shell den isxyei sto pipe */
+            }
+
+            /* Redirect to output sto epomeno pipe (MONO AN DEN EINAI TO TELEFTAIO COMMAND) */
+            if (p[1] >= 0)
+            {
+                dup2(p[1], STDOUT_FILENO);
+            }
+
+            /* ta prev_read, p[0], p[1] einai O_CLOEXEC kai kleinoun sto execvp */
+            exec_stage(pipeline->stages[i], i, p[1] >= 0);
+        }
+
+        /* setpgid kai apo ton parent, gia na mhn yparxei race me to child */
+        if (own_group)
+        {
+            if (pgid == 0)
+            {
+                pgid=pid;
+            }
+            setpgid(pid, pgid);
+        }
+        pids[started++]=pid;
+        STAT_INC(forks);
+        STAT_INC(commands);
+        if (TRACE_ON) trace_proc("fork", pid, i, pipeline->stages[i]->text, 0);
+
+        /* Parent kanei close ta akra pou phgan sto child */
+        if (prev_read >= 0)
+        {
+            close(prev_read);
+        }
+        if (p[1] >= 0)
+        {
+            close(p[1]);
+        }
+        prev_read=p[0];
+    }
+    if (prev_read >= 0)
+    {
+        close(prev_read);
+    }
+
+    struct sigaction saved_sigs[FORWARD_SIGS];
+    int forwarding=pgid != 0 && !job_control();
+    if (forwarding)
+    {
+        forward_start(pgid, saved_sigs);
+    }
+    else if (pgid != 0)
+    {
+        give_terminal(pgid);
+    }
+
+    /* Wait gia ola ta children mazi (pidfd + epoll), me to deadline tou timeout */
+    StrBuf pipestatus;
+    sb_init(&pipestatus);
+    int *statuses=malloc((started > 0 ? started : 1) * sizeof(int));
+    uint64_t wait_start=stats_now_ns();
+    shstat->wait_since=wait_start;
+    int timed_out=wait_pids(pids, started, statuses, pgid, pipeline->timeout != NULL ? &deadline : NULL);
+    shstat->wait_since=0;
+    STAT_ADD(wait_ns, stats_now_ns() - wait_start);
+    int status=0;
+    for (int i = 0; i < started; i++)
+    {
+        char code[16];
+        status=statuses[i];
+        if (TRACE_ON) trace_proc("exit", pids[i], i, pipeline->stages[i]->text, status_code(status));
+        int len=snprintf(code, sizeof(code), "%d", status_code(status));
+        array_push(&pipestatus, code, len);
+    }
+    if (forwarding)
+    {
+        forward_stop(saved_sigs);
+    }
+    else if (pgid != 0)
+    {
+        give_terminal(getpgrp());
+    }
+
+    if (timed_out)
+    {
+        last_exit_status = TIMEOUT_STATUS;
+    }
+    else if (started == cmd_c)
+    {
+        last_exit_status = status_code(status);
+    }
+    else
+    {
+        last_exit_status = 1;
+    }
+    set_array("PIPESTATUS", &pipestatus, started, 0);
+    sb_free(&pipestatus);
+    free(statuses);
+    free(pids);
+}
+
+/*
+ * Ektelesh tou if-then-fi statement
+ * Ektelei to condition, ektelei to body an to exit status einai 0
+ */
+static void exec_if(Node *n, int flags)
+{
+    /* Execute condition and check exit status */
+    exec_nodes(n->cond, 0);
+
+    if (last_exit_status == 0)
+    {
+        exec_nodes(n->body, flags);
+    }
+}
+
+/*
+ * Ektelesh for loop
+ * Ta words ginontai expand mia fora se elements (vl. expand_words), kai to VAR
+ * pairnei ka8e element me th seira. Gia for x in "${a[@]}" to loop pairnei ena
+ * antigrafo tou vector tou array (ena memcpy, xwris re-splitting), opote to body
+ * mporei na allaxei h na xanaorisei to array
+ * To body exei hdh ginei parse, opote ka8e iteration to ektelei kateu8eian
+ */
+static void exec_for(Node *n)
+{
+    StrBuf list;
+    sb_init(&list);
+    int count;
+    Var *arr = array_ref(n->words);
+    if (arr != NULL)
+    {
+        if (arr->elems.len > 0)
+        {
+            sb_append(&list, arr->elems.data, arr->elems.len);
+        }
+        count = arr->count;
+    }
+    else
+    {
+        count = expand_words(n->words, &list);
+    }
+
+    size_t off = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const char *value = array_next(&list, &off);
+        if (value == NULL)
+        {
+            break;
+        }
+        set_var(n->var, value);
+        exec_nodes(n->body, 0);
+    }
+    sb_free(&list);
+}
+
+/*
+ * Ektelesh while loop: to body trexei oso to condition epistrefei 0
+ * Exit status: tou teleftaiou command tou body (0 an den etrexe pote)
+ */
+static void exec_while(Node *n)
+{
+    int status = 0;
+    while (1)
+    {
+        exec_nodes(n->cond, 0);
+        if (last_exit_status != 0)
+        {
+            break;
+        }
+        exec_nodes(n->body, 0);
+        status = last_exit_status;
+    }
+    last_exit_status = status;
+}
+
+/*
+ * ( BODY ): ena fork gia olo to list, opote cd, assignments kai exit menoun
+ * sto child. To teleftaio command tou body kanei tail-exec sto child, ara
+ * to ( cd dir; make ) kostizei ena mono fork
+ * An to subshell einai to teleftaio command tou shell (EXEC_TAIL), den
+ * xreiazetai kan fork: to body trexei kateu8eian
+ */
+static void exec_subshell(Node *n, int flags)
+{
+    if ((flags & EXEC_TAIL) && can_tail_exec())
+    {
+        exec_nodes(n->body, flags);
+        return;
+    }
+
+    reader_sync_all(); /* to child synexizei to stdin apo ekei pou emeine to read */
+    fflush(NULL);      /* alliws ta stdio buffers grafontai kai apo to child */
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        last_exit_status = 1;
+        return;
+    }
+    if (pid == 0)
+    {
+        stats_forked();
+        shell_interactive = 0;
+        terminal_owner = 0;
+        exec_nodes(n->body, EXEC_TAIL);
+        fflush(NULL);
+        exit(last_exit_status);
+    }
+
+    int status;
+    STAT_INC(forks);
+    if (TRACE_ON) trace_proc("fork", pid, 0, "( ... )", 0);
+    wait_for(pid, &status);
+    if (TRACE_ON) trace_proc("exit", pid, 0, "( ... )", status_code(status));
+    last_exit_status = status_code(status);
+}
+
+/*
+ * Ektelesh enos node (xwris ta redirections tou block)
+ * To { BODY; } trexei sto idio process: ta redirections tou (vl. exec_redirected)
+ * anoigoun mia fora gia olo to group
+ */
+static void exec_node(Node *n, int flags)
+{
+    switch (n->type)
+    {
+    case NODE_CMD:
+        execute_cmd(n->text, flags);
+        break;
+    case NODE_PIPELINE:
+        pipelining(n);
+        break;
+    case NODE_IF:
+        exec_if(n, flags);
+        break;
+    case NODE_FOR:
+        exec_for(n);
+        break;
+    case NODE_WHILE:
+        exec_while(n);
+        break;
+    case NODE_GROUP:
+        exec_nodes(n->body, flags);
+        break;
+    case NODE_SUBSHELL:
+        exec_subshell(n, flags);
+        break;
+    }
+}
+
+/*
+ * Block me redirections (p.x. while read line; do ...; done < file):
+ * ta redirections efarmozontai mia fora gyrw apo olo to block kai epanerxontai meta
+ */
+static void exec_redirected(Node *n, int flags)
+{
+    SimpleCmd c;
+    char expanded[MAX_LINE];
+    strncpy(expanded, var_expansion(n->redir), MAX_LINE - 1);
+    expanded[MAX_LINE - 1] = '\0';
+    tokenize_cmd(expanded, &c);
+
+    int saved[2];
+    if (push_redirections(&c, saved) == 0)
+    {
+        exec_node(n, flags);
+    }
+    else
+    {
+        last_exit_status = 1;
+    }
+    pop_redirections(saved);
+}
+
+/*
+ * Ektelei ena list apo nodes me th seira
+ * To EXEC_TAIL pernaei mono sto teleftaio node ths listas
+ */
+void exec_nodes(Node *n, int flags)
+{
+    for (; n != NULL; n = n->next)
+    {
+        int node_flags = n->next == NULL ? flags : 0;
+        if (n->redir != NULL)
+        {
+            exec_redirected(n, node_flags);
+        }
+        else
+        {
+            exec_node(n, node_flags);
+        }
+    }
+}
+
+/*
+ * Parse and execute command line input
+ * To parse_list() ftiaxnei to syntax tree kai to exec_nodes() to ektelei
+ * flags: EXEC_TAIL an meta apo afto to input to shell telionei
+ */
+void parse_and_exec(const char *line, int flags)
+{
+    static int depth = 0; /* nested klhseis metrane mia fora, sto exwteriko */
+    uint64_t start = depth == 0 ? stats_now_ns() : 0;
+    if (depth == 0)
+    {
+        shstat->exec_since = start;
+    }
+    depth++;
+    if (TRACE_ON) trace_span('B', "parse", line);
+    Node *n=parse_list(line);
+    if (TRACE_ON) trace_span('E', "parse", "");
+    if (depth == 1)
+    {
+        STAT_ADD(parse_ns, stats_now_ns() - start);
+    }
+    exec_nodes(n, flags);
+    free_nodes(n);
+    depth--;
+    if (depth == 0)
+    {
+        shstat->exec_since = 0;
+        STAT_ADD(exec_ns, stats_now_ns() - start);
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ *  csd5127: George Kiosklis
+ *  Fuzz target gia ta entry points tou parser (parse_list, var_expansion, tokenize_cmd)
+ *  Tipota den ektelitai, ara to fuzzing den kanei fork/exec
+ *
+ *  libFuzzer:  make fuzz && ./fuzz/fuzz_parse corpus_dir/
+ *  standalone: make fuzz-standalone && ./fuzz/fuzz_parse file1 file2 ... (h stdin)
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hy345sh.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    char *text = my_strndup((const char *)data, size);
+    if (text == NULL)
+    {
+        return 0;
+    }
+
+    Node *n = parse_list(text);
+    free_nodes(n);
+
+    /* Ka8e grammh: expansion kai tokenization opws sto execute_cmd() */
+    char expanded[MAX_LINE];
+    SimpleCmd cmd;
+    char *save = NULL;
+    for (char *line = strtok_r(text, "\n", &save); line != NULL; line = strtok_r(NULL, "\n", &save))
+    {
+        strncpy(expanded, var_expansion(line), MAX_LINE - 1);
+        expanded[MAX_LINE - 1] = '\0';
+        tokenize_cmd(expanded, &cmd);
+    }
+    free(text);
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+static void run_file(FILE *f)
+{
+    StrBuf buf;
+    char chunk[4096];
+    size_t n;
+    sb_init(&buf);
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    {
+        sb_append(&buf, chunk, n);
+    }
+    LLVMFuzzerTestOneInput((const uint8_t *)(buf.data ? buf.data : ""), buf.len);
+    sb_free(&buf);
+}
+
+int main(int argc, char *argv[])
+{
+    set_var("x", "value with spaces");
+    if (argc < 2)
+    {
+        run_file(stdin);
+        return 0;
+    }
+    for (int i = 1; i < argc; i++)
+    {
+        FILE *f = fopen(argv[i], "rb");
+        if (f == NULL)
+        {
+            perror(argv[i]);
+            continue;
+        }
+        run_file(f);
+        fclose(f);
+    }
+    return 0;
+}
+#endif
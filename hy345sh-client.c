@@ -0,0 +1,41 @@
+/*
+ *  csd5127: George Kiosklis
+ *  Client gia to hy345sh --server: stelnei commands ston server mazi me ta
+ *  stdin/stdout/stderr tou, opote to output erxetai kateu8eian edw
+ *
+ *  Usage: hy345sh-client SOCKET 'commands' ['commands' ...]
+ *  Ola ta commands trexoun sto idio session (p.x. to cd h ena assignment
+ *  isxyei kai gia ta epomena). Exit status: tou teleftaiou command
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "hy345sh.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s SOCKET 'commands' ['commands' ...]\n", argv[0]);
+        return 2;
+    }
+    int sock = server_connect(argv[1]);
+    if (sock < 0)
+    {
+        perror(argv[1]);
+        return 127;
+    }
+    int status = 0;
+    for (int i = 2; i < argc; i++)
+    {
+        if (server_request(sock, argv[i], &status) != 0)
+        {
+            fprintf(stderr, "%s: connection to server lost\n", argv[0]);
+            return 127;
+        }
+    }
+    close(sock);
+    return status;
+}
@@ -0,0 +1,395 @@
+/*
+ *  csd5127: George Kiosklis
+ *  Shell core library (libhy345sh.a): koines dhlwseis
+ *
+ *  Ta modules tou core:
+ *    util.c   - strings kai growable buffers
+ *    trace.c  - execution tracing (Chrome trace-event JSON)
+ *    input.c  - buffered readers ana fd, read builtin kai incremental scanner
+ *    vars.c   - shell variables, indexed arrays kai variable expansion
+ *    parse.c  - parser se syntax tree kai tokenizer twn commands
+ *    exec.c   - ektelesh tou syntax tree, builtins, pipelines
+ *    cache.c  - cached builtin (content-addressed result cache)
+ *    path.c   - PATH lookup cache gia ta external commands
+ *    server.c - server mode se unix socket kai to client protocol
+ *    stats.c  - runtime counters (shstat, SIGUSR1 snapshot)
+ *    pipebuf.c - pipe capacity (PIPESIZE) kai to buffer stage
+ *    prompt.c - to PS1 prompt (compiled segments)
+ *    snapshot.c - source builtin kai binary snapshot tou shell state
+ *    wait.c   - anamonh twn children (pidfd + epoll) kai timeout deadlines
+ *  To hy345sh.c exei mono to REPL (prompt kai main loop), to hy345sh-client.c
+ *  ton client tou server mode
+ */
+
+#ifndef HY345SH_H
+#define HY345SH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define MAX_LINE 4096     /* Maximum line length for input */
+#define MAX_ARGS 128      /* Maximum number of command arguments */
+#define MAX_VAR_NAME 64   /* Maximum variable name length */
+#define MAX_VAR_VALUE 512 /* Maximum variable value length */
+
+/* ---------------------------------------------------------------- util.c */
+
+char *my_strdup(const char *s);
+char *my_strndup(const char *s, size_t n);
+int status_code(int status);
+long parse_size(const char *text);
+
+/*
+ * Growable string buffer (diplasiazei to capacity, ara ta appends einai amortized O(1))
+ */
+typedef struct
+{
+    char *data;
+    size_t len;
+    size_t cap;
+} StrBuf;
+
+void sb_init(StrBuf *sb);
+void sb_append(StrBuf *sb, const char *s, size_t n);
+void sb_reset(StrBuf *sb);
+void sb_free(StrBuf *sb);
+
+/* --------------------------------------------------------------- trace.c */
+
+extern int trace_fd;
+extern pid_t trace_pid;
+
+/* Ka8e trace hook einai ena branch otan to tracing einai off */
+#define TRACE_ON (trace_fd >= 0)
+#define TRACE_EVENT_MAX 2048
+
+int trace_start(const char *path);
+void trace_stop(void);
+void trace_span(char ph, const char *name, const char *text);
+void trace_proc(const char *event, pid_t pid, int stage, const char *cmd, int status);
+void trace_fork(pid_t pid, int stage, char **argv);
+void trace_exec(int stage, char **argv);
+void trace_exit(pid_t pid, int stage, char **argv, int status);
+
+/* --------------------------------------------------------------- input.c */
+
+/*
+ * Control flow keywords pou anagnwrizei o scanner
+ */
+enum
+{
+    KW_NONE = 0,
+    KW_IF,
+    KW_THEN,
+    KW_FI,
+    KW_FOR,
+    KW_DO,
+    KW_DONE,
+    KW_WHILE,
+    KW_LBRACE, /* { */
+    KW_RBRACE, /* } */
+    KW_LPAREN, /* ( se command position (operator, oxi word) */
+    KW_RPAREN  /* ) pou kleinei subshell */
+};
+
+#define SCAN_WORD_MAX 8
+
+/*
+ * Katastash tou incremental scanner (vl. scan_char)
+ */
+typedef struct
+{
+    int depth;       /* anoixta if/for/while blocks, { } groups kai ( ) subshells */
+    int in_quotes;   /* mesa se "..." */
+    int cmd_pos;     /* to epomeno word einai se command position */
+    int parens;      /* anoixta ( ) subshells */
+    int word_parens; /* ( mesa se word, p.x. a=(x y) h $(...) */
+    char last;       /* o prohgoumenos xarakthras (ektos quotes) */
+    int prefix;      /* mesa sta options tou timeout prefix (vl. scan_prefix) */
+    int word_len;    /* mhkos tou trexontos word (mporei > SCAN_WORD_MAX) */
+    char word[SCAN_WORD_MAX];
+} ScanState;
+
+int check_keyword(const char *key);
+void scan_init(ScanState *st);
+int scan_char(ScanState *st, char c);
+void scan_feed(ScanState *st, const char *text, size_t len);
+int scan_complete(const ScanState *st);
+const char *find_keyword(const char *start, int kw, int depth);
+
+#define READ_CHUNK 65536
+
+/*
+ * Buffered input reader: diavazei se blocks me read(2)
+ * Enas ana fd (reader_get), koinos gia to REPL kai to read builtin
+ */
+typedef struct
+{
+    int fd;
+    size_t pos;
+    size_t len;
+    int eof;
+    int seekable; /* regular file: to lookahead epistrefei me lseek prin to fork */
+    int synced;   /* to offset exei gyrisei piso (reader_sync), to buffer isxyei akoma */
+    int cloexec;  /* to fd den to klhronomoun ta children */
+    off_t end_off; /* file offset sto telos tou buffer (seekable) */
+    char buf[READ_CHUNK];
+} Reader;
+
+void reader_init(Reader *r, int fd);
+int reader_getdelim(Reader *r, StrBuf *out, int delim);
+int reader_getline(Reader *r, StrBuf *out);
+int reader_at_eof(Reader *r);
+int read_complete_cmd(Reader *r, StrBuf *out);
+Reader *reader_get(int fd);
+void reader_forget(int fd);
+void reader_move(int from, int to);
+void reader_sync_all(void);
+int builtin_read(int argc, char **argv);
+
+/* ---------------------------------------------------------------- vars.c */
+
+/*
+ * structure gia thn apo8hkeysh name-value pairs
+ * Ena array (is_array) krataei ta elements sto elems: contiguous vector apo
+ * [uint32 len][bytes]['\0'], count elements (vl. array_push/array_next)
+ */
+typedef struct
+{
+    char name[MAX_VAR_NAME];
+    char *value;       /* malloc, to poly MAX_VAR_VALUE - 1 chars (value_cap 0: "" h mesa sto snapshot) */
+    size_t value_cap;  /* megalwnei mono, opote to value grafetai sth 8esh tou */
+    int is_array;
+    int count;
+    StrBuf elems;      /* elems.cap 0 me data: deixnei mesa sto snapshot */
+} Var;
+
+extern Var **variable; /* var_count pointers, me th seira pou orisththkan */
+extern int var_count;
+
+/*
+ * Ena variable opws einai sto backing store (p.x. to mapped snapshot):
+ * to value (scalar, NUL-terminated) h to vector (array) menei ekei
+ */
+typedef struct
+{
+    const char *value;
+    size_t len;
+    int is_array;
+    int count;
+} VarImage;
+
+/*
+ * Backing store gia variables pou den exoun ginei akoma Var (vl. vars_attach)
+ * lookup: 1 me to variable sto *out, 0 an den yparxei
+ * name_at: to onoma tou variable i < count (NULL an to record einai xalasmeno)
+ */
+typedef struct
+{
+    int (*lookup)(const char *name, VarImage *out);
+    const char *(*name_at)(uint32_t i);
+    uint32_t count;
+    uint64_t bytes; /* synolo gia to var_bytes */
+} VarBacking;
+
+void vars_attach(const VarBacking *b);
+void vars_load_all(void);
+
+char *get_Var(const char *name);
+void set_var(const char *name, const char *value);
+char *var_expansion(const char *input);
+void array_push(StrBuf *v, const char *s, size_t n);
+const char *array_next(const StrBuf *v, size_t *off);
+Var *get_array(const char *name);
+Var *array_ref(const char *word);
+void set_array(const char *name, const StrBuf *elems, int count, int append);
+int expand_words(const char *words, StrBuf *out);
+void assign_array(const char *name, const char *list, int append);
+
+/* --------------------------------------------------------------- parse.c */
+
+/*
+ * Syntax tree: to parse_list() kanei parse ena input mia fora,
+ * kai to exec_nodes() to ektelei (p.x. ka8e iteration enos for xwris re-parse)
+ */
+typedef enum
+{
+    NODE_CMD,      /* aplo command h assignment (text xwris expansion) */
+    NODE_PIPELINE, /* cmd1 | cmd2 | ... */
+    NODE_IF,       /* if COND; then BODY; fi */
+    NODE_FOR,      /* for VAR in WORDS; do BODY; done */
+    NODE_WHILE,    /* while COND; do BODY; done */
+    NODE_GROUP,    /* { BODY; } sto idio process */
+    NODE_SUBSHELL  /* ( BODY ) se ena forked child */
+} NodeType;
+
+typedef struct Node
+{
+    NodeType type;
+    char *text;           /* NODE_CMD: to command opws grafthke (kai ka8e pipeline stage, gia trace) */
+    char *var;            /* NODE_FOR: onoma tou loop variable */
+    char *words;          /* NODE_FOR: oi times meta to "in" (xwris expansion) */
+    struct Node **stages; /* NODE_PIPELINE: ena node ana stage (NODE_CMD h block) */
+    int nstages;
+    char *pipesize;       /* NODE_PIPELINE: to PIPESIZE= prefix (NULL an den yparxei) */
+    struct Node *cond;    /* NODE_IF / NODE_WHILE */
+    struct Node *body;    /* NODE_IF / NODE_FOR / NODE_WHILE / NODE_GROUP / NODE_SUBSHELL */
+    char *redir;          /* redirections meta to fi/done/}/) (p.x. "< file"), NULL an den yparxoun */
+    char *timeout;        /* NODE_PIPELINE: ta options tou timeout prefix (NULL an den yparxei) */
+    struct Node *next;    /* epomeno command sth lista (;) */
+} Node;
+
+/*
+ * Ena command meta to tokenization: argv kai redirections
+ * Ta strings deixnoun mesa sto buffer pou edwse o caller
+ */
+typedef struct
+{
+    char *argv[MAX_ARGS];
+    int argc;
+    char *input_file;
+    char *output_file;
+    int append;
+} SimpleCmd;
+
+Node *parse_list(const char *text);
+void free_nodes(Node *n);
+int is_assignment(const char *cmd);
+void tokenize_cmd(char *line, SimpleCmd *cmd);
+
+/* ---------------------------------------------------------------- exec.c */
+
+extern int last_exit_status;
+extern int shell_interactive;
+
+/* flags gia exec_nodes/execute_cmd/parse_and_exec */
+#define EXEC_TAIL 1  /* teleftaio command tou shell: exec xwris fork (an epitrepetai) */
+#define EXEC_STAGE 2 /* pipeline stage sto child: to command to metrhse hdh to pipelining */
+
+void exec_nodes(Node *n, int flags);
+void execute_cmd(const char *cmd, int flags);
+void pipelining(Node *pipeline);
+void parse_and_exec(const char *line, int flags);
+
+/* --------------------------------------------------------------- cache.c */
+
+int builtin_cached(int argc, char **argv);
+
+/* ---------------------------------------------------------------- path.c */
+
+const char *path_lookup(const char *name);
+void path_forget(const char *name);
+int path_fill(void);
+void exec_path(char **argv);
+
+/* -------------------------------------------------------------- server.c */
+
+#define SERVER_MAGIC 0x68793331u /* "hy31" */
+
+/*
+ * Header enos request (mazi me 3 fds se SCM_RIGHTS), meta akolou8oun
+ * len bytes: "cwd\0command\0". H apanthsh einai ena int32 exit status
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t len;
+} ServerRequest;
+
+int server_run(const char *path);
+int server_connect(const char *path);
+int server_request(int sock, const char *cmd, int *status);
+
+/* --------------------------------------------------------------- stats.c */
+
+/*
+ * Megethos twn variables enos process, to krataei to vars.c me ka8e allagh
+ * Ena forked child pou synexizei na trexei shell code (stats_forked) to
+ * allazei se diko tou antigrafo, wste na mhn metraei sta variables tou parent
+ */
+typedef struct
+{
+    uint64_t vars;
+    uint64_t var_bytes;     /* onomata, values kai array vectors */
+} VarStats;
+
+/*
+ * Runtime counters (shared me ta forked children, vl. stats_init)
+ * Oi xronoi einai se ns
+ */
+typedef struct
+{
+    uint64_t commands;      /* simple commands kai pipeline stages */
+    uint64_t builtins;
+    uint64_t externals;
+    uint64_t assignments;
+    uint64_t pipelines;
+    uint64_t forks;
+    uint64_t execs;         /* exec attempts (metrane kai ta children) */
+    uint64_t exec_failures;
+    uint64_t exec_ns;       /* synolo mesa sto parse_and_exec() */
+    uint64_t parse_ns;      /* apo afta, sto parse_list() */
+    uint64_t wait_ns;       /* apo afta, sto waitpid() gia children */
+    uint64_t exec_since;    /* start tou trexontos parse_and_exec() (0 an den trexei) */
+    uint64_t wait_since;    /* start tou trexontos waitpid() (0 an den trexei) */
+    uint64_t children_maxrss_kb; /* to megalytero ru_maxrss apo ta wait4 */
+    uint64_t cache_hits;    /* cached builtin (kai se pipeline stages) */
+    uint64_t cache_misses;
+    uint64_t cache_stores;
+    uint64_t cache_evictions;
+    VarStats var;           /* ta variables tou process pou ekane to stats_init */
+} ShellStats;
+
+extern ShellStats *shstat;
+extern VarStats *var_stats; /* &shstat->var, h topiko antigrafo se forked child */
+
+#define STAT_INC(field) __atomic_fetch_add(&shstat->field, 1, __ATOMIC_RELAXED)
+#define STAT_ADD(field, n) __atomic_fetch_add(&shstat->field, (n), __ATOMIC_RELAXED)
+#define VAR_STAT_ADD(field, n) (var_stats->field += (n)) /* enas writer, to idio to process */
+
+uint64_t stats_now_ns(void);
+void stats_init(void);
+void stats_forked(void);
+void stats_child_maxrss(uint64_t kb);
+int builtin_shstat(int argc, char **argv);
+
+/* ------------------------------------------------------------- pipebuf.c */
+
+long pipe_size_for(const Node *pipeline);
+void pipe_set_size(int fd, long size);
+int buffer_run(long size, int out_private);
+
+/* -------------------------------------------------------------- prompt.c */
+
+void prompt_render(StrBuf *out);
+void prompt_cwd_changed(void);
+
+/* ------------------------------------------------------------ snapshot.c */
+
+int source_file(const char *path);
+int builtin_source(int argc, char **argv);
+int snapshot_save(const char *path, const char *rc);
+int snapshot_restore(const char *path);
+int builtin_snapshot(int argc, char **argv);
+
+/* ---------------------------------------------------------------- wait.c */
+
+/*
+ * Deadline enos timeout: sto deadline_ns (CLOCK_MONOTONIC) stelnetai sig sto
+ * process group, kai kill_after_ns argotera SIGKILL (0: xwris SIGKILL)
+ */
+typedef struct
+{
+    uint64_t deadline_ns;
+    int sig;
+    uint64_t kill_after_ns;
+} WaitDeadline;
+
+#define TIMEOUT_STATUS 124 /* exit status otan eftase to deadline */
+
+int wait_pids(const pid_t *pids, int n, int *statuses, pid_t pgid, const WaitDeadline *dl);
+void wait_for(pid_t pid, int *status);
+int timeout_parse(const char *options, WaitDeadline *dl);
+
+#endif
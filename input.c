@@ -0,0 +1,655 @@
+/*
+ *  csd5127: George Kiosklis
+ *  Input: buffered reader kai incremental scanner gia multiline commands
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "hy345sh.h"
+
+/*
+ * Kanei check an yparxei word pou einai shell control flow keyword
+ * Returns: to KW_* id tou keyword h KW_NONE
+ */
+int check_keyword(const char *key)
+{
+    static const char *names[] = {"", "if", "then", "fi", "for", "do", "done", "while", "{", "}"};
+    for (int i = KW_IF; i <= KW_RBRACE; i++)
+    {
+        if (strcmp(key, names[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return KW_NONE;
+}
+
+/*
+ * Incremental scanner gia to an ena command einai syntaktika oloklhrwmeno
+ * Trwei enan xarakthra th fora, opote mporei na synexisei apo ekei pou emeine
+ * otan erthei h epomenh grammh (linear xronos, xwris re-scan)
+ * Ta keywords metrane mono se command position kai ektos quotes,
+ * ara "echo profile" h "cat file" den allazoun to depth
+ * To { kai to } einai keywords (words), to ( kai to ) operators: to ( metraei
+ * mono se command position kai to ) mono an kleinei subshell, opote to
+ * a=(x y) kai to $(...) menoun mesa sto word
+ */
+void scan_init(ScanState *st)
+{
+    memset(st, 0, sizeof(*st));
+    st->cmd_pos = 1;
+}
+
+/*
+ * To timeout DURATION [-s SIG] [-k DURATION] einai prefix: to command meta ta
+ * options einai pali se command position (p.x. timeout 5 { a; b; })
+ * st->prefix: 1 prin to duration, 3 meta, +1 otan akolou8ei to orisma enos -s/-k
+ * Returns: 1 an to word anhkei sto prefix
+ */
+static int scan_prefix(ScanState *st)
+{
+    if (st->prefix == 0)
+    {
+        if (st->cmd_pos && st->word_len == 7 && strncmp(st->word, "timeout", 7) == 0)
+        {
+            st->prefix = 1;
+            return 1;
+        }
+        return 0;
+    }
+    int opt = st->word_len == 2 && st->word[0] == '-' && (st->word[1] == 's' || st->word[1] == 'k');
+    if (st->prefix == 3 && !opt)
+    {
+        st->prefix = 0; /* to command */
+        return 0;
+    }
+    if (st->prefix % 2 == 0)
+    {
+        st->prefix--;
+    }
+    else
+    {
+        st->prefix = opt ? st->prefix + 1 : 3;
+    }
+    return 1;
+}
+
+/*
+ * Kleinei to trexon word kai enhmerwnei depth/cmd_pos
+ * Returns: to keyword pou teleiwse (mono se command position) h KW_NONE
+ */
+static int scan_word(ScanState *st)
+{
+    int kw = KW_NONE;
+    if (scan_prefix(st))
+    {
+        st->word_len = 0;
+        return KW_NONE;
+    }
+    if (st->cmd_pos && st->word_len < SCAN_WORD_MAX)
+    {
+        st->word[st->word_len] = '\0';
+        kw = check_keyword(st->word);
+    }
+    st->word_len = 0;
+    switch (kw)
+    {
+    case KW_IF:
+    case KW_WHILE:
+    case KW_LBRACE:
+        st->depth++;
+        break;
+    case KW_FOR:
+        st->depth++;
+        st->cmd_pos = 0; /* akolou8ei to onoma tou variable */
+        break;
+    case KW_THEN:
+    case KW_DO:
+        break;
+    case KW_FI:
+    case KW_DONE:
+    case KW_RBRACE:
+        st->depth--;
+        st->cmd_pos = 0;
+        break;
+    default:
+        st->cmd_pos = 0;
+        break;
+    }
+    return kw;
+}
+
+/*
+ * Trofodotei ena xarakthra ston scanner ('\0' = telos input, kleinei to teleftaio word)
+ * Returns: to keyword pou teleiwse se afton ton xarakthra h KW_NONE
+ */
+int scan_char(ScanState *st, char c)
+{
+    if (st->in_quotes)
+    {
+        if (c == '"')
+        {
+            st->in_quotes = 0;
+        }
+        return KW_NONE;
+    }
+    if (c == '"')
+    {
+        st->in_quotes = 1;
+        st->word_len = SCAN_WORD_MAX; /* word me quotes den einai pote keyword */
+        return KW_NONE;
+    }
+    char prev = st->last;
+    st->last = c;
+    if (c == '(')
+    {
+        if (st->word_len == 0 && st->cmd_pos)
+        {
+            st->prefix = 0;
+            st->depth++;
+            st->parens++;
+            return KW_LPAREN;
+        }
+        if (prev == '=' || prev == '$')
+        {
+            st->word_parens++;
+        }
+    }
+    else if (c == ')')
+    {
+        if (st->word_parens > 0)
+        {
+            st->word_parens--;
+        }
+        else if (st->parens > 0)
+        {
+            if (st->word_len > 0)
+            {
+                scan_word(st);
+            }
+            st->depth--;
+            st->parens--;
+            st->cmd_pos = 0;
+            return KW_RPAREN;
+        }
+    }
+    if (c == ' ' || c == '\t' || c == '\n' || c == ';' || c == '|' || c == '&' ||
+        c == '<' || c == '>' || c == '[' || c == '\0')
+    {
+        int kw = KW_NONE;
+        if (st->word_len > 0)
+        {
+            kw = scan_word(st);
+        }
+        if (c == ';' || c == '\n' || c == '|' || c == '&')
+        {
+            st->cmd_pos = 1;
+            st->prefix = 0;
+        }
+        return kw;
+    }
+    if (st->word_len < SCAN_WORD_MAX)
+    {
+        st->word[st->word_len] = c;
+    }
+    if (st->word_len <= SCAN_WORD_MAX)
+    {
+        st->word_len++;
+    }
+    return KW_NONE;
+}
+
+void scan_feed(ScanState *st, const char *text, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        scan_char(st, text[i]);
+    }
+}
+
+/*
+ * Returns: 1 an to input pou exei dei o scanner einai oloklhrwmeno command
+ * (ola ta if/for/while, { } groups kai ( ) subshells exoun kleisei kai den eimaste mesa se quotes)
+ */
+int scan_complete(const ScanState *st)
+{
+    return st->depth <= 0 && !st->in_quotes;
+}
+
+/*
+ * Vriskei to keyword kw tou block pou xekinaei sto start (p.x. to "then" h to matching "fi")
+ * depth: to depth pou prepei na exei o scanner meta to keyword
+ *        (1 gia then/do, 0 gia to fi/done pou kleinei to block)
+ * Returns: pointer sthn arxh tou keyword h NULL
+ */
+const char *find_keyword(const char *start, int kw, int depth)
+{
+    ScanState st;
+    scan_init(&st);
+    for (const char *p = start;; p++)
+    {
+        int found = scan_char(&st, *p);
+        if (found == kw && st.depth == depth && (kw == KW_LPAREN || kw == KW_RPAREN))
+        {
+            return p; /* operator, oxi word */
+        }
+        if (found == kw && st.depth == depth)
+        {
+            /* to keyword teleiwse akrivws prin to p */
+            const char *k = p;
+            while (k > start && k[-1] != ' ' && k[-1] != '\t' && k[-1] != '\n' && k[-1] != ';' && k[-1] != '|' && k[-1] != '&')
+            {
+                k--;
+            }
+            return k;
+        }
+        if (*p == '\0')
+        {
+            return NULL;
+        }
+    }
+}
+
+/*
+ * Buffered input reader: diavazei se blocks me read(2) kai dinei grammes
+ * xwris orio sto mhkos (h grammh mpainei se StrBuf)
+ * Se seekable arxeia kratha kai to offset sto telos tou buffer, gia to reader_sync
+ */
+void reader_init(Reader *r, int fd)
+{
+    struct stat sb;
+    r->fd = fd;
+    r->pos = 0;
+    r->len = 0;
+    r->eof = 0;
+    r->synced = 0;
+    r->seekable = fstat(fd, &sb) == 0 && (S_ISREG(sb.st_mode) || S_ISBLK(sb.st_mode));
+    r->end_off = r->seekable ? lseek(fd, 0, SEEK_CUR) : 0;
+    if (r->end_off < 0)
+    {
+        r->seekable = 0;
+        r->end_off = 0;
+    }
+    int flags = fcntl(fd, F_GETFD);
+    r->cloexec = flags >= 0 && (flags & FD_CLOEXEC);
+}
+
+/*
+ * Prin apo fork/exec: se seekable fd to offset gyrnaei piso sto prwto
+ * byte pou den exei diavastei apo to buffer, wste to child na synexisei
+ * apo ekei. To buffer menei, kai to reader_resume to xanaxrhsimopoiei
+ * an to child den diavase tipota
+ */
+static void reader_sync(Reader *r)
+{
+    if (r->seekable && !r->synced && r->pos < r->len)
+    {
+        lseek(r->fd, r->end_off - (off_t)(r->len - r->pos), SEEK_SET);
+        r->synced = 1;
+    }
+}
+
+/*
+ * Meta apo reader_sync: an to offset den allaxe, to buffer isxyei akoma
+ * (lseek sto telos tou), alliws kapoio child diavase kai to buffer petietai
+ */
+static void reader_resume(Reader *r)
+{
+    if (!r->synced)
+    {
+        return;
+    }
+    r->synced = 0;
+    off_t cur = lseek(r->fd, 0, SEEK_CUR);
+    if (cur == r->end_off - (off_t)(r->len - r->pos))
+    {
+        lseek(r->fd, r->end_off, SEEK_SET);
+    }
+    else
+    {
+        r->pos = 0;
+        r->len = 0;
+        r->eof = 0;
+        r->end_off = cur < 0 ? 0 : cur;
+    }
+}
+
+/*
+ * Gemizei to buffer an einai adeio
+ * Returns: 1 an yparxoun data, 0 sto EOF
+ */
+static int reader_fill(Reader *r)
+{
+    reader_resume(r);
+    while (r->pos == r->len)
+    {
+        if (r->eof)
+        {
+            return 0;
+        }
+        ssize_t n = read(r->fd, r->buf, sizeof(r->buf));
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            r->eof = 1;
+            return 0;
+        }
+        r->pos = 0;
+        r->len = n;
+        r->end_off += n;
+    }
+    return 1;
+}
+
+/*
+ * Kanei append ena kommati mexri kai to delim (mazi me to delim an yparxei) sto out
+ * Returns: 1 an diavastike kati, 0 sto EOF
+ */
+int reader_getdelim(Reader *r, StrBuf *out, int delim)
+{
+    int got = 0;
+    while (reader_fill(r))
+    {
+        char *start = r->buf + r->pos;
+        char *end = memchr(start, delim, r->len - r->pos);
+        size_t n = end != NULL ? (size_t)(end - start) + 1 : r->len - r->pos;
+        sb_append(out, start, n);
+        r->pos += n;
+        got = 1;
+        if (end != NULL)
+        {
+            return 1;
+        }
+    }
+    return got;
+}
+
+/*
+ * Kanei append mia grammh (mazi me to '\n' an yparxei) sto out
+ * Returns: 1 an diavastike kati, 0 sto EOF
+ */
+int reader_getline(Reader *r, StrBuf *out)
+{
+    return reader_getdelim(r, out, '\n');
+}
+
+/*
+ * Kanei peek an o reader exei ftasei sto telos tou input
+ * (gemizei to buffer an einai adeio, ara mporei na kanei block se pipe/terminal)
+ * Returns: 1 an den yparxoun alla data, 0 alliws
+ */
+int reader_at_eof(Reader *r)
+{
+    return !reader_fill(r);
+}
+
+/*
+ * Registry: enas Reader (lookahead buffer) ana fd, koinos gia to REPL kai to read builtin
+ * Ta redirections tou shell metaferoun ton Reader mazi me to fd (reader_move),
+ * opote to lookahead akolou8ei to open file kai oxi ton ari8mo tou fd
+ */
+static Reader **readers = NULL;
+static int readers_cap = 0;
+
+/*
+ * Returns: o Reader tou fd (ftiaxnetai thn prwth fora)
+ */
+Reader *reader_get(int fd)
+{
+    if (fd >= readers_cap)
+    {
+        int cap = readers_cap ? readers_cap : 16;
+        while (cap <= fd)
+        {
+            cap *= 2;
+        }
+        readers = realloc(readers, cap * sizeof(Reader *));
+        if (readers == NULL)
+        {
+            perror("realloc");
+            exit(1);
+        }
+        memset(readers + readers_cap, 0, (cap - readers_cap) * sizeof(Reader *));
+        readers_cap = cap;
+    }
+    if (readers[fd] == NULL)
+    {
+        readers[fd] = malloc(sizeof(Reader));
+        if (readers[fd] == NULL)
+        {
+            perror("malloc");
+            exit(1);
+        }
+        reader_init(readers[fd], fd);
+    }
+    return readers[fd];
+}
+
+/*
+ * To fd 8a deixnei se allo arxeio (dup2/close): to lookahead tou paliou
+ * epistrefei sto arxeio (an einai seekable) kai o Reader adeiazei
+ * To Reader object menei (to REPL mporei na exei pointer se afto)
+ */
+void reader_forget(int fd)
+{
+    if (fd < readers_cap && readers[fd] != NULL)
+    {
+        reader_sync(readers[fd]);
+        reader_init(readers[fd], fd);
+    }
+}
+
+/*
+ * dup2(from, to) + close(from) apo ta redirections: o Reader tou from pernaei sto to
+ * O Reader pou htan sto to (to arxeio tou eklise) svhnetai
+ */
+void reader_move(int from, int to)
+{
+    if (from >= readers_cap || readers[from] == NULL)
+    {
+        reader_forget(to);
+        return;
+    }
+    reader_get(to);
+    free(readers[to]);
+    readers[to] = readers[from];
+    readers[from] = NULL;
+    readers[to]->fd = to;
+    int flags = fcntl(to, F_GETFD);
+    readers[to]->cloexec = flags >= 0 && (flags & FD_CLOEXEC);
+}
+
+/*
+ * Prin apo fork/exec: reader_sync se olous tous Readers pou 8a klhronomhsei to child
+ */
+void reader_sync_all(void)
+{
+    for (int fd = 0; fd < readers_cap; fd++)
+    {
+        if (readers[fd] != NULL && !readers[fd]->cloexec)
+        {
+            reader_sync(readers[fd]);
+        }
+    }
+}
+
+/*
+ * Diavazei ena oloklhrwmeno command sto out: mia grammh, h perissoteres an
+ * anoixe if/for block (h quotes) pou den exei kleisei akoma
+ * Returns: 1 an diavastike command, 0 sto EOF
+ */
+int read_complete_cmd(Reader *r, StrBuf *out)
+{
+    ScanState st;
+    scan_init(&st);
+    sb_reset(out);
+    size_t scanned = 0;
+    while (reader_getline(r, out))
+    {
+        scan_feed(&st, out->data + scanned, out->len - scanned);
+        scanned = out->len;
+        if (scan_complete(&st))
+        {
+            return 1;
+        }
+    }
+    return out->len > 0;
+}
+
+/*
+ * IFS splitting gia to read: ta IFS whitespace (space, tab, newline) enwnontai,
+ * ka8e allos IFS xarakthras xwrizei akrivws ena field
+ * mask[i] != 0: o xarakthras htan escaped me backslash (den xwrizei)
+ */
+static int is_ifs(const char *ifs, const char *mask, const char *s, size_t i)
+{
+    return !mask[i] && s[i] != '\0' && strchr(ifs, s[i]) != NULL;
+}
+
+static int is_ifs_space(const char *ifs, const char *mask, const char *s, size_t i)
+{
+    return is_ifs(ifs, mask, s, i) && (s[i] == ' ' || s[i] == '\t' || s[i] == '\n');
+}
+
+/*
+ * read [-r] [-d delim] [var...]
+ * Diavazei apo to stdin mexri to delim (default newline) mesa apo ton Reader
+ * tou fd 0: ena read(2) ana block kai memchr, oxi ena syscall ana byte
+ * Xwris -r to backslash kanei escape ton epomeno xarakthra kai to backslash-delim
+ * synexizei sthn epomenh grammh. Ta fields mpainoun sta vars me to IFS, to
+ * teleftaio var pairnei oti perisseyei (xwris var: REPLY)
+ * Returns: 0, h 1 sto EOF (ta vars pairnoun oti diavastike)
+ */
+int builtin_read(int argc, char **argv)
+{
+    int raw = 0;
+    int delim = '\n';
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++)
+    {
+        if (strcmp(argv[i], "-r") == 0)
+        {
+            raw = 1;
+        }
+        else if (strncmp(argv[i], "-d", 2) == 0)
+        {
+            const char *d = argv[i][2] != '\0' ? argv[i] + 2 : (i + 1 < argc ? argv[++i] : NULL);
+            if (d == NULL)
+            {
+                fprintf(stderr, "read: -d: option requires an argument\n");
+                return 2;
+            }
+            delim = (unsigned char)d[0];
+        }
+        else
+        {
+            fprintf(stderr, "usage: read [-r] [-d delim] [var...]\n");
+            return 2;
+        }
+    }
+
+    Reader *r = reader_get(STDIN_FILENO);
+    StrBuf line;
+    sb_init(&line);
+    int found = 0;
+    while (reader_getdelim(r, &line, delim))
+    {
+        found = line.len > 0 && (unsigned char)line.data[line.len - 1] == delim;
+        if (!found)
+        {
+            break;
+        }
+        line.data[--line.len] = '\0';
+        /* backslash-delim: synexeia sthn epomenh grammh (mono xwris -r) */
+        size_t bs = 0;
+        while (bs < line.len && line.data[line.len - 1 - bs] == '\\')
+        {
+            bs++;
+        }
+        if (raw || bs % 2 == 0)
+        {
+            break;
+        }
+        line.data[--line.len] = '\0';
+        found = 0;
+    }
+    sb_append(&line, "", 0);
+
+    /* backslash removal: to text xwris ta escapes kai ena mask gia tous escaped xarakthres */
+    char *text = malloc(line.len + 1);
+    char *mask = calloc(line.len + 1, 1);
+    size_t n = 0;
+    for (size_t k = 0; k < line.len; k++)
+    {
+        if (!raw && line.data[k] == '\\' && k + 1 < line.len)
+        {
+            k++;
+            mask[n] = 1;
+        }
+        text[n++] = line.data[k];
+    }
+    text[n] = '\0';
+    mask[n] = 0;
+
+    /* antigrafo, giati to read IFS ... allazei to idio to IFS */
+    char ifs[MAX_VAR_VALUE];
+    const char *ifs_var = get_Var("IFS");
+    snprintf(ifs, sizeof(ifs), "%s", ifs_var != NULL ? ifs_var : " \t\n");
+    char *default_var[] = {"REPLY"};
+    char **vars = i < argc ? argv + i : default_var;
+    int nvars = i < argc ? argc - i : 1;
+
+    size_t p = 0;
+    for (int v = 0; v < nvars; v++)
+    {
+        while (is_ifs_space(ifs, mask, text, p))
+        {
+            p++;
+        }
+        size_t start = p, end;
+        if (v == nvars - 1)
+        {
+            /* to teleftaio var: olo to ypoloipo xwris ta IFS whitespace sto telos */
+            end = n;
+            while (end > start && is_ifs_space(ifs, mask, text, end - 1))
+            {
+                end--;
+            }
+            p = n;
+        }
+        else
+        {
+            while (p < n && !is_ifs(ifs, mask, text, p))
+            {
+                p++;
+            }
+            end = p;
+            while (is_ifs_space(ifs, mask, text, p))
+            {
+                p++;
+            }
+            if (is_ifs(ifs, mask, text, p))
+            {
+                p++; /* enas non-whitespace IFS xarakthras kleinei to field */
+            }
+        }
+        char save = text[end];
+        text[end] = '\0';
+        set_var(vars[v], text + start);
+        text[end] = save;
+    }
+
+    free(text);
+    free(mask);
+    sb_free(&line);
+    return found ? 0 : 1;
+}
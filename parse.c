@@ -0,0 +1,626 @@
+/*
+ *  csd5127: George Kiosklis
+ *  Parser: metatrepei to input se syntax tree (Node) xwris na ektelesei tipota,
+ *  kai tokenizer pou spaei ena (expanded) command se argv kai redirections
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hy345sh.h"
+
+static Node *node_new(NodeType type)
+{
+    Node *n = calloc(1, sizeof(Node));
+    if (n == NULL)
+    {
+        perror("calloc");
+        exit(1);
+    }
+    n->type = type;
+    return n;
+}
+
+/*
+ * Kanei free ena olo to list (kai ta children tou ka8e node)
+ */
+void free_nodes(Node *n)
+{
+    while (n != NULL)
+    {
+        Node *next = n->next;
+        free(n->text);
+        free(n->var);
+        free(n->words);
+        for (int i = 0; i < n->nstages; i++)
+        {
+            free_nodes(n->stages[i]);
+        }
+        free(n->stages);
+        free(n->pipesize);
+        free(n->timeout);
+        free_nodes(n->cond);
+        free_nodes(n->body);
+        free(n->redir);
+        free(n);
+        n = next;
+    }
+}
+
+/*
+ * Check an to cmd einai variable assignment (x=value or x="value with spaces")
+ * Dhladh exei (=) pou den einai sthn arxh kai xwris special char prin to (=)
+ * Returns: 1 an einai assignment, 0 alliws
+ */
+int is_assignment(const char *cmd)
+{
+    const char *eq = strchr(cmd, '=');
+    if (eq == NULL || eq == cmd)
+    {
+        return 0;
+    }
+    for (const char *p = cmd; p < eq; p++)
+    {
+        if (*p == ' ' || *p == '>' || *p == '<' || *p == '|')
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Check an to cmd xekinaei me to word kw (p.x. "if" alla oxi "ifconfig")
+ */
+static int starts_with_word(const char *cmd, const char *kw)
+{
+    size_t n = strlen(kw);
+    if (strncmp(cmd, kw, n) != 0)
+    {
+        return 0;
+    }
+    char c = cmd[n];
+    return c == '\0' || c == ' ' || c == '\t' || c == '\n' || c == ';' || c == '[';
+}
+
+/*
+ * Ta redirections meta to fi/done/}/) enos block (p.x. "done < file")
+ * Returns: 0 (kai to n->redir an yparxoun), -1 gia syntax error
+ */
+static int parse_block_redir(Node *n, const char *rest, const char *kw)
+{
+    while (*rest == ' ' || *rest == '\t')
+    {
+        rest++;
+    }
+    if (*rest == '\0')
+    {
+        return 0;
+    }
+    if (*rest != '<' && *rest != '>')
+    {
+        fprintf(stderr, "Syntax error: unexpected '%s' after '%s'\n", rest, kw);
+        return -1;
+    }
+    n->redir = my_strdup(rest);
+    return 0;
+}
+
+/*
+ * if COND; then BODY; fi
+ * To then kai to matching fi vriskontai me ton scanner, opote douleyoun nested blocks
+ * kai words opws "file"/"profile" mesa sto body
+ */
+static Node *parse_if(const char *line)
+{
+    const char *then = find_keyword(line, KW_THEN, 1);
+    if (then == NULL)
+    {
+        fprintf(stderr, "Syntax error: 'then' expected\n");
+        return NULL;
+    }
+
+    const char *fi = find_keyword(line, KW_FI, 0);
+    if (fi == NULL || fi < then)
+    {
+        fprintf(stderr, "Syntax error: 'fi' expected\n");
+        return NULL;
+    }
+
+    char *condition = my_strndup(line + 2, then - (line + 2));
+    char *body = my_strndup(then + 4, fi - (then + 4));
+    Node *n = node_new(NODE_IF);
+    n->cond = parse_list(condition);
+    n->body = parse_list(body);
+    free(condition);
+    free(body);
+    if (parse_block_redir(n, fi + 2, "fi") != 0)
+    {
+        free_nodes(n);
+        return NULL;
+    }
+    return n;
+}
+
+/*
+ * for VAR in VALUE1 VALUE2 ...; do BODY; done
+ * Oi times kratiountai xwris expansion, ginontai expand se ka8e ektelesh tou loop
+ */
+static Node *parse_for(const char *line)
+{
+    const char *in = strstr(line, " in ");
+    if (in == NULL)
+    {
+        fprintf(stderr, "Syntax error: 'in' expected\n");
+        return NULL;
+    }
+
+    const char *var_start = line + 3;
+    while (var_start < in && (*var_start == ' ' || *var_start == '\t'))
+    {
+        var_start++;
+    }
+    const char *var_end = in;
+    while (var_end > var_start && (var_end[-1] == ' ' || var_end[-1] == '\t'))
+    {
+        var_end--;
+    }
+    if (var_end == var_start || var_end - var_start >= MAX_VAR_NAME)
+    {
+        fprintf(stderr, "Syntax error: bad for variable\n");
+        return NULL;
+    }
+
+    const char *do_pos = find_keyword(line, KW_DO, 1);
+    if (do_pos == NULL || do_pos < in)
+    {
+        fprintf(stderr, "Syntax error: 'do' expected\n");
+        return NULL;
+    }
+    const char *done = find_keyword(line, KW_DONE, 0);
+    if (done == NULL || done < do_pos)
+    {
+        fprintf(stderr, "Syntax error: 'done' expected\n");
+        return NULL;
+    }
+
+    char *body = my_strndup(do_pos + 2, done - (do_pos + 2));
+    Node *n = node_new(NODE_FOR);
+    n->var = my_strndup(var_start, var_end - var_start);
+    n->words = my_strndup(in + 4, do_pos - (in + 4));
+    n->body = parse_list(body);
+    free(body);
+    if (parse_block_redir(n, done + 4, "done") != 0)
+    {
+        free_nodes(n);
+        return NULL;
+    }
+    return n;
+}
+
+/*
+ * while COND; do BODY; done [< file]
+ * To do kai to matching done vriskontai me ton scanner opws sto for
+ */
+static Node *parse_while(const char *line)
+{
+    const char *do_pos = find_keyword(line, KW_DO, 1);
+    if (do_pos == NULL)
+    {
+        fprintf(stderr, "Syntax error: 'do' expected\n");
+        return NULL;
+    }
+    const char *done = find_keyword(line, KW_DONE, 0);
+    if (done == NULL || done < do_pos)
+    {
+        fprintf(stderr, "Syntax error: 'done' expected\n");
+        return NULL;
+    }
+
+    char *condition = my_strndup(line + 5, do_pos - (line + 5));
+    char *body = my_strndup(do_pos + 2, done - (do_pos + 2));
+    Node *n = node_new(NODE_WHILE);
+    n->cond = parse_list(condition);
+    n->body = parse_list(body);
+    free(condition);
+    free(body);
+    if (parse_block_redir(n, done + 4, "done") != 0)
+    {
+        free_nodes(n);
+        return NULL;
+    }
+    return n;
+}
+
+/*
+ * { BODY; } [redirections]
+ * To matching } vrisketai me ton scanner (keyword se command position), opote
+ * douleyoun nested groups kai to } mesa se words (p.x. ${a[@]})
+ */
+static Node *parse_group(const char *line)
+{
+    const char *close = find_keyword(line, KW_RBRACE, 0);
+    if (close == NULL)
+    {
+        fprintf(stderr, "Syntax error: '}' expected\n");
+        return NULL;
+    }
+
+    char *body = my_strndup(line + 1, close - (line + 1));
+    Node *n = node_new(NODE_GROUP);
+    n->body = parse_list(body);
+    free(body);
+    if (parse_block_redir(n, close + 1, "}") != 0)
+    {
+        free_nodes(n);
+        return NULL;
+    }
+    return n;
+}
+
+/*
+ * ( BODY ) [redirections]
+ */
+static Node *parse_subshell(const char *line)
+{
+    const char *close = find_keyword(line, KW_RPAREN, 0);
+    if (close == NULL)
+    {
+        fprintf(stderr, "Syntax error: ')' expected\n");
+        return NULL;
+    }
+
+    char *body = my_strndup(line + 1, close - (line + 1));
+    Node *n = node_new(NODE_SUBSHELL);
+    n->body = parse_list(body);
+    free(body);
+    if (parse_block_redir(n, close + 1, ")") != 0)
+    {
+        free_nodes(n);
+        return NULL;
+    }
+    return n;
+}
+
+/*
+ * Vriskei to prwto (|) pou xwrizei pipeline stages: ektos quotes kai ektos
+ * blocks, ara to | mesa se { ...; } h ( ... ) anhkei sto stage
+ * Returns: pointer sto | h NULL
+ */
+static const char *find_pipe(const char *line)
+{
+    ScanState st;
+    scan_init(&st);
+    for (const char *p = line; *p != '\0'; p++)
+    {
+        scan_char(&st, *p);
+        if (*p == '|' && !st.in_quotes && st.depth <= 0)
+        {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+static Node *parse_command(const char *cmd);
+
+/*
+ * Prosthetei ena stage sto pipeline
+ * To text tou stage krateitai kai gia blocks, gia to trace kai ta stats
+ */
+static void pipeline_add(Node *pipeline, Node *stage, const char *text)
+{
+    if (pipeline->nstages % 4 == 0)
+    {
+        pipeline->stages = realloc(pipeline->stages, (pipeline->nstages + 4) * sizeof(Node *));
+        if (pipeline->stages == NULL)
+        {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    if (stage->text == NULL)
+    {
+        stage->text = my_strdup(text);
+    }
+    pipeline->stages[pipeline->nstages++] = stage;
+}
+
+/*
+ * xirismos twn command pipelines p.x. (cmd1 | cmd2 | cmd3 | ...)
+ * Kanei split sto (|) ektos quotes kai blocks (xwris orio sta stages)
+ * Ka8e stage einai NODE_CMD h block ({ }, ( ), if, for, while)
+ * Returns: to NODE_PIPELINE h NULL gia syntax error se kapoio stage
+ */
+static Node *parse_pipeline(const char *line)
+{
+    Node *n = node_new(NODE_PIPELINE);
+    const char *start = line;
+    while (1)
+    {
+        const char *bar = find_pipe(start);
+        const char *end = bar != NULL ? bar : start + strlen(start);
+        while (start < end && (*start == ' ' || *start == '\t'))
+        {
+            start++;
+        }
+        if (start < end)
+        {
+            char *text = my_strndup(start, end - start);
+            Node *stage = parse_command(text);
+            if (stage == NULL)
+            {
+                free(text);
+                free_nodes(n);
+                return NULL;
+            }
+            pipeline_add(n, stage, text);
+            free(text);
+        }
+        if (bar == NULL)
+        {
+            break;
+        }
+        start = bar + 1;
+    }
+    return n;
+}
+
+/*
+ * timeout DURATION [-s SIG] [-k DURATION] cmd1 | cmd2 ...
+ * To timeout afora olo to pipeline pou akolou8ei (opws to PIPESIZE= prefix),
+ * opote ena aplo command h block ginetai pipeline me ena stage. Ta options kratiountai
+ * xwris expansion kai ginontai parse sthn ektelesh (vl. timeout_parse)
+ */
+static Node *parse_timeout(const char *line)
+{
+    const char *p = line + 7;
+    int have_duration = 0;
+    while (1)
+    {
+        while (*p == ' ' || *p == '\t')
+        {
+            p++;
+        }
+        size_t len = strcspn(p, " \t");
+        int opt = len == 2 && (strncmp(p, "-s", 2) == 0 || strncmp(p, "-k", 2) == 0);
+        if (len == 0 || (!opt && have_duration))
+        {
+            break;
+        }
+        p += len;
+        if (opt)
+        {
+            while (*p == ' ' || *p == '\t')
+            {
+                p++;
+            }
+            p += strcspn(p, " \t");
+        }
+        else
+        {
+            have_duration = 1;
+        }
+    }
+    if (!have_duration || *p == '\0')
+    {
+        fprintf(stderr, "usage: timeout DURATION [-s SIG] [-k DURATION] cmd [| cmd ...]\n");
+        return NULL;
+    }
+
+    Node *n = parse_command(p);
+    if (n == NULL)
+    {
+        return NULL;
+    }
+    if (n->type != NODE_PIPELINE)
+    {
+        /* aplo command h block: pipeline me ena stage (trexei se child) */
+        Node *pipeline = node_new(NODE_PIPELINE);
+        pipeline_add(pipeline, n, p);
+        n = pipeline;
+    }
+    if (n->timeout == NULL) /* se nested timeout isxyei to eswteriko */
+    {
+        n->timeout = my_strndup(line + 7, p - (line + 7));
+    }
+    return n;
+}
+
+/*
+ * Ena command (xwris top-level ;) -> pipeline, if, for, while, { } group,
+ * ( ) subshell h aplo command
+ * To pipeline elegxetai prwto, giati ena block mporei na einai stage tou
+ * (p.x. { a; b; } | c), enw to | mesa se block den metraei (vl. find_pipe)
+ */
+static Node *parse_command(const char *cmd)
+{
+    if (starts_with_word(cmd, "timeout"))
+    {
+        return parse_timeout(cmd);
+    }
+    /* PIPESIZE=SIZE cmd1 | cmd2: pipe capacity mono gia afto to pipeline */
+    const char *space = strpbrk(cmd, " \t");
+    if (strncmp(cmd, "PIPESIZE=", 9) == 0 && space != NULL && find_pipe(space) != NULL &&
+        memchr(cmd, '"', space - cmd) == NULL)
+    {
+        Node *n = parse_pipeline(space);
+        if (n != NULL)
+        {
+            n->pipesize = my_strndup(cmd + 9, space - (cmd + 9));
+        }
+        return n;
+    }
+    /* ena assignment den einai pote pipeline, akoma kai me (|) sto value */
+    int block = cmd[0] == '(' || starts_with_word(cmd, "{");
+    if ((block || !is_assignment(cmd)) && find_pipe(cmd) != NULL)
+    {
+        return parse_pipeline(cmd);
+    }
+    if (starts_with_word(cmd, "if"))
+    {
+        return parse_if(cmd);
+    }
+    if (starts_with_word(cmd, "for"))
+    {
+        return parse_for(cmd);
+    }
+    if (starts_with_word(cmd, "while"))
+    {
+        return parse_while(cmd);
+    }
+    if (starts_with_word(cmd, "{"))
+    {
+        return parse_group(cmd);
+    }
+    if (cmd[0] == '(')
+    {
+        return parse_subshell(cmd);
+    }
+    Node *n = node_new(NODE_CMD);
+    n->text = my_strdup(cmd);
+    return n;
+}
+
+/*
+ * Parse command line input se lista apo nodes
+ * Kanei split to input sta semicolons kai newlines (respecting quotes kai control structures)
+ * O scanner krataei to depth twn if/for/while/{ }/( ), opote mono keywords se command position metrane
+ * Den allazei to text kai den ektelei tipota
+ * Returns: to prwto node ths listas (NULL gia keno input)
+ */
+Node *parse_list(const char *text)
+{
+    Node *head = NULL;
+    Node **tail = &head;
+    const char *start = text;
+    ScanState st;
+    scan_init(&st);
+    for (const char *p = text;; p++)
+    {
+        scan_char(&st, *p);
+
+        /* Split mono an den einai se quotes kai den einai mesa se control structure */
+        if (((*p == ';' || *p == '\n') && !st.in_quotes && st.depth <= 0) || *p == '\0')
+        {
+            /* Trim spaces */
+            while (start < p && (*start == ' ' || *start == '\t' || *start == '\n'))
+            {
+                start++;
+            }
+            if (start < p)
+            {
+                char *cmd = my_strndup(start, p - start);
+                Node *n = parse_command(cmd);
+                free(cmd);
+                if (n != NULL)
+                {
+                    *tail = n;
+                    tail = &n->next;
+                }
+            }
+            start = p + 1;
+        }
+        if (*p == '\0')
+        {
+            break;
+        }
+    }
+    return head;
+}
+
+/*
+ * Tokenizer: spaei to (hdh expanded) line se argv kai redirections (<, >, >>)
+ * Ypostirizei kai embedded redirection opws: cat<file, ls>out
+ * To line allazei (strtok) kai ta pointers tou cmd deixnoun mesa tou
+ */
+void tokenize_cmd(char *line, SimpleCmd *cmd)
+{
+    cmd->argc = 0;
+    cmd->input_file = NULL;
+    cmd->output_file = NULL;
+    cmd->append = 0;
+
+    char *token = strtok(line, " \t\n");
+    while (token != NULL && cmd->argc < MAX_ARGS - 1)
+    {
+        if (strcmp(token, "<") == 0)
+        {
+            token=strtok(NULL, " \t\n");
+            if (token != NULL)
+            {
+                cmd->input_file=token;
+            }
+        }
+        else if (strcmp(token, ">") == 0)
+        {
+            token=strtok(NULL, " \t\n");
+            if (token != NULL)
+            {
+                cmd->output_file=token;
+                cmd->append=0; /* Overwrite */
+            }
+        }
+        else if (strcmp(token, ">>") == 0)
+        {
+            token=strtok(NULL, " \t\n");
+            if (token != NULL)
+            {
+                cmd->output_file=token;
+                cmd->append=1; /* Append */
+            }
+        }
+        else
+        {
+            /* check gia embedded redirection opws: cat<file, ls>out */
+            char *redir=strchr(token, '>');
+            if (redir != NULL)
+            {
+                if (redir[1] == '>')
+                {
+                    /* >> embedded */
+                    *redir='\0';
+                    if (strlen(token) > 0)
+                    {
+                        cmd->argv[cmd->argc++]=token;
+                    }
+                    cmd->output_file=redir + 2;
+                    cmd->append = 1;
+                }
+                else
+                {
+                    /* > embedded */
+                    *redir='\0';
+                    if (strlen(token) > 0)
+                    {
+                        cmd->argv[cmd->argc++] = token;
+                    }
+                    cmd->output_file=redir + 1;
+                    cmd->append=0;
+                }
+            }
+            else
+            {
+                redir = strchr(token, '<');
+                if (redir != NULL)
+                {
+                    /* < embedded (p.x. cat<file) */
+                    *redir='\0';
+                    if (strlen(token) > 0)
+                    {
+                        cmd->argv[cmd->argc++] = token;
+                    }
+                    cmd->input_file = redir + 1;
+                }
+                else
+                {
+                    /* Aplo argument */
+                    cmd->argv[cmd->argc++]=token;
+                }
+            }
+        }
+        token=strtok(NULL, " \t\n");
+    }
+    cmd->argv[cmd->argc] = NULL;
+}
@@ -0,0 +1,249 @@
+/*
+ *  csd5127: George Kiosklis
+ *  PATH lookup cache: command name -> full path, gia na mhn psaxnei to execvp
+ *  ola ta directories tou PATH se ka8e ektelesh
+ *
+ *  To cache gemizei lazily (path_lookup ston parent prin to fork) h olo mazi
+ *  me to path_fill (server mode, opote ola ta sessions to klhronomoun me to fork)
+ *  An allaxei to PATH to cache adeiazei
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "hy345sh.h"
+
+typedef struct
+{
+    char *name;
+    char *path;
+} PathEntry;
+
+static PathEntry *table = NULL; /* open addressing, size power of 2 */
+static size_t table_size = 0;
+static size_t table_used = 0;
+static char *cached_path_var = NULL; /* to PATH gia to opoio isxyei to cache */
+
+static size_t path_hash(const char *s)
+{
+    size_t h = 5381;
+    while (*s)
+    {
+        h = h * 33 + (unsigned char)*s++;
+    }
+    return h;
+}
+
+static void table_clear(void)
+{
+    for (size_t i = 0; i < table_size; i++)
+    {
+        free(table[i].name);
+        free(table[i].path);
+    }
+    free(table);
+    table = NULL;
+    table_size = 0;
+    table_used = 0;
+}
+
+static PathEntry *table_slot(const char *name)
+{
+    size_t i = path_hash(name) & (table_size - 1);
+    while (table[i].name != NULL && strcmp(table[i].name, name) != 0)
+    {
+        i = (i + 1) & (table_size - 1);
+    }
+    return &table[i];
+}
+
+static void table_insert(const char *name, const char *path)
+{
+    if ((table_used + 1) * 2 > table_size)
+    {
+        PathEntry *old = table;
+        size_t old_size = table_size;
+        table_size = old_size ? old_size * 2 : 256;
+        table = calloc(table_size, sizeof(PathEntry));
+        if (table == NULL)
+        {
+            perror("calloc");
+            exit(1);
+        }
+        for (size_t i = 0; i < old_size; i++)
+        {
+            if (old[i].name != NULL)
+            {
+                *table_slot(old[i].name) = old[i];
+            }
+        }
+        free(old);
+    }
+    PathEntry *e = table_slot(name);
+    if (e->name != NULL)
+    {
+        return; /* to prwto directory tou PATH kerdizei */
+    }
+    e->name = my_strdup(name);
+    e->path = my_strdup(path);
+    table_used++;
+}
+
+/*
+ * Adeiazei to cache an to PATH den einai afto gia to opoio gemise
+ */
+static const char *path_check(void)
+{
+    const char *path = getenv("PATH");
+    if (path == NULL)
+    {
+        path = "/usr/local/bin:/usr/bin:/bin";
+    }
+    if (cached_path_var == NULL || strcmp(cached_path_var, path) != 0)
+    {
+        table_clear();
+        free(cached_path_var);
+        cached_path_var = my_strdup(path);
+    }
+    return path;
+}
+
+static int is_executable(const char *path)
+{
+    struct stat sb;
+    return stat(path, &sb) == 0 && S_ISREG(sb.st_mode) && access(path, X_OK) == 0;
+}
+
+/*
+ * Vriskei to full path enos command (oxi gia names me '/')
+ * Returns: pointer mesa sto cache (isxyei mexri to epomeno path_forget/allagh PATH)
+ * h NULL an den vre8hke
+ */
+const char *path_lookup(const char *name)
+{
+    if (strchr(name, '/') != NULL || *name == '\0')
+    {
+        return NULL;
+    }
+    const char *path = path_check();
+    if (table_size > 0)
+    {
+        PathEntry *e = table_slot(name);
+        if (e->name != NULL)
+        {
+            return e->path;
+        }
+    }
+
+    char full[MAX_LINE];
+    const char *dir = path;
+    while (1)
+    {
+        const char *end = strchr(dir, ':');
+        size_t len = end != NULL ? (size_t)(end - dir) : strlen(dir);
+        snprintf(full, sizeof(full), "%.*s/%s", (int)len, len > 0 ? dir : ".", name);
+        if (is_executable(full))
+        {
+            table_insert(name, full);
+            return table_slot(name)->path;
+        }
+        if (end == NULL)
+        {
+            return NULL;
+        }
+        dir = end + 1;
+    }
+}
+
+/*
+ * Svhnei ena entry pou den isxyei pia (p.x. to arxeio svhsthke)
+ * Me open addressing den ginetai aplo delete, opote xanaxtizei to table
+ */
+void path_forget(const char *name)
+{
+    if (table_size == 0 || table_slot(name)->name == NULL)
+    {
+        return;
+    }
+    PathEntry *old = table;
+    size_t old_size = table_size;
+    table = NULL;
+    table_size = 0;
+    table_used = 0;
+    for (size_t i = 0; i < old_size; i++)
+    {
+        if (old[i].name != NULL && strcmp(old[i].name, name) != 0)
+        {
+            table_insert(old[i].name, old[i].path);
+        }
+        free(old[i].name);
+        free(old[i].path);
+    }
+    free(old);
+}
+
+/*
+ * Gemizei to cache me ola ta executables olwn twn directories tou PATH
+ * Returns: to plh8os twn entries
+ */
+int path_fill(void)
+{
+    const char *path = path_check();
+    const char *dir = path;
+    char dname[MAX_LINE];
+    char full[MAX_LINE + 256];
+    while (1)
+    {
+        const char *end = strchr(dir, ':');
+        size_t len = end != NULL ? (size_t)(end - dir) : strlen(dir);
+        snprintf(dname, sizeof(dname), "%.*s", (int)len, len > 0 ? dir : ".");
+        DIR *d = opendir(dname);
+        if (d != NULL)
+        {
+            struct dirent *de;
+            while ((de = readdir(d)) != NULL)
+            {
+                if (de->d_name[0] == '.')
+                {
+                    continue;
+                }
+                snprintf(full, sizeof(full), "%s/%s", dname, de->d_name);
+                if (is_executable(full))
+                {
+                    table_insert(de->d_name, full);
+                }
+            }
+            closedir(d);
+        }
+        if (end == NULL)
+        {
+            break;
+        }
+        dir = end + 1;
+    }
+    return (int)table_used;
+}
+
+/*
+ * execvp mesw tou cache: an to cached path den douleyei pia, fallback sto execvp
+ * Epistrefei mono an apotyxei kai to execvp (to errno einai tou execvp)
+ */
+void exec_path(char **argv)
+{
+    const char *full = path_lookup(argv[0]);
+    STAT_INC(execs);
+    if (full != NULL)
+    {
+        execv(full, argv);
+        path_forget(argv[0]);
+    }
+    execvp(argv[0], argv);
+    int saved = errno;
+    STAT_INC(exec_failures);
+    errno = saved;
+}
@@ -0,0 +1,197 @@
+/*
+ *  csd5127: George Kiosklis
+ *  Pipe capacity (PIPESIZE) kai to buffer stage twn pipelines
+ *
+ *  PIPESIZE=SIZE (shell variable, h prefix enos pipeline: PIPESIZE=4M a | b)
+ *  megalwnei ta pipes tou pipeline me F_SETPIPE_SZ, mexri to
+ *  /proc/sys/fs/pipe-max-size
+ *
+ *  "buffer SIZE" san pipeline stage: to forked child tou stage den kanei exec,
+ *  alla antigrafei stdin -> stdout mesa apo ena ring buffer SIZE bytes, wste
+ *  enas bursty producer na mhn stamataei otan o consumer argei
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+
+#include "hy345sh.h"
+
+#define BUFFER_HEAP_MAX (1024 * 1024) /* megalytera rings mpainoun se memfd */
+#define PIPE_MAX_DEFAULT (1024 * 1024)
+
+/*
+ * To max pipe size tou systhmatos (diavazetai mia fora)
+ */
+static long pipe_max_size(void)
+{
+    static long max = 0;
+    if (max == 0)
+    {
+        FILE *f = fopen("/proc/sys/fs/pipe-max-size", "r");
+        if (f == NULL || fscanf(f, "%ld", &max) != 1 || max <= 0)
+        {
+            max = PIPE_MAX_DEFAULT;
+        }
+        if (f != NULL)
+        {
+            fclose(f);
+        }
+    }
+    return max;
+}
+
+/*
+ * To pipe size gia ena pipeline: to PIPESIZE= prefix tou pipeline, alliws
+ * to PIPESIZE shell variable
+ * Returns: bytes, 0 gia to default tou kernel
+ */
+long pipe_size_for(const Node *pipeline)
+{
+    const char *text = pipeline->pipesize != NULL ? pipeline->pipesize : get_Var("PIPESIZE");
+    if (text == NULL || *text == '\0')
+    {
+        return 0;
+    }
+    long size = parse_size(text);
+    if (size < 0)
+    {
+        fprintf(stderr, "PIPESIZE: invalid size '%s'\n", text);
+        return 0;
+    }
+    return size;
+}
+
+/*
+ * F_SETPIPE_SZ sto pipe, clamped sto max tou systhmatos
+ * An o kernel to arnh8ei (p.x. orio pipe-user-pages gia unprivileged users)
+ * to pipe menei sto default
+ */
+void pipe_set_size(int fd, long size)
+{
+    long max = pipe_max_size();
+    if (size <= 0)
+    {
+        return;
+    }
+    if (size > max)
+    {
+        size = max;
+    }
+    fcntl(fd, F_SETPIPE_SZ, (int)size);
+}
+
+/*
+ * To ring tou buffer stage: sto heap an einai mikro, alliws se memfd
+ * (shmem pages, pou ginontai swap anti na megalwnoun to heap tou process)
+ */
+static char *buffer_alloc(size_t size)
+{
+    if (size <= BUFFER_HEAP_MAX)
+    {
+        return malloc(size);
+    }
+    int fd = memfd_create("hy345sh-buffer", MFD_CLOEXEC);
+    if (fd < 0 || ftruncate(fd, size) != 0)
+    {
+        perror("buffer: memfd");
+        return NULL;
+    }
+    char *ring = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return ring == MAP_FAILED ? NULL : ring;
+}
+
+/*
+ * buffer SIZE: stdin -> ring buffer -> stdout mexri EOF kai adeiasma tou ring
+ * Diavazei oso yparxei xwros kai grafei oso dexetai to stdout, me poll() sta dyo
+ * To stdout ginetai O_NONBLOCK mono an einai pipe tou idiou pipeline (out_private),
+ * wste ena partial write na mhn mplokarei to diavasma
+ * Returns: exit status tou stage
+ */
+int buffer_run(long size, int out_private)
+{
+    char *ring = buffer_alloc(size);
+    if (ring == NULL)
+    {
+        return 1;
+    }
+    if (out_private)
+    {
+        fcntl(STDOUT_FILENO, F_SETFL, fcntl(STDOUT_FILENO, F_GETFL) | O_NONBLOCK);
+    }
+
+    size_t head = 0, used = 0; /* to ring: [head, head + used) mod size */
+    int eof = 0;
+    while (!eof || used > 0)
+    {
+        struct pollfd pfd[2];
+        int n = 0, in_i = -1, out_i = -1;
+        if (!eof && used < (size_t)size)
+        {
+            in_i = n;
+            pfd[n].fd = STDIN_FILENO;
+            pfd[n++].events = POLLIN;
+        }
+        if (used > 0)
+        {
+            out_i = n;
+            pfd[n].fd = STDOUT_FILENO;
+            pfd[n++].events = POLLOUT;
+        }
+        if (poll(pfd, n, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("buffer: poll");
+            return 1;
+        }
+
+        if (in_i >= 0 && pfd[in_i].revents)
+        {
+            size_t tail = (head + used) % size;
+            size_t room = (size_t)size - used;
+            if (room > (size_t)size - tail)
+            {
+                room = size - tail;
+            }
+            ssize_t r = read(STDIN_FILENO, ring + tail, room);
+            if (r > 0)
+            {
+                used += r;
+            }
+            else if (r == 0 || (errno != EINTR && errno != EAGAIN))
+            {
+                eof = 1;
+            }
+        }
+
+        if (out_i >= 0 && pfd[out_i].revents)
+        {
+            if (pfd[out_i].revents & (POLLERR | POLLNVAL))
+            {
+                return 1;
+            }
+            size_t chunk = (size_t)size - head < used ? (size_t)size - head : used;
+            ssize_t w = write(STDOUT_FILENO, ring + head, chunk);
+            if (w > 0)
+            {
+                head = (head + w) % size;
+                used -= w;
+            }
+            else if (w < 0 && errno != EINTR && errno != EAGAIN)
+            {
+                perror("buffer: write");
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,229 @@
+/*
+ *  csd5127: George Kiosklis
+ *  To prompt (PS1): compiled se segments mia fora, otan allaxei to PS1
+ *
+ *  Escapes: \u user, \h host (ws thn prwth '.'), \H host, \w cwd, \W basename
+ *  tou cwd, \$ ('#' gia root), \? exit status tou teleftaiou command,
+ *  \t wra HH:MM:SS, \n newline, \\ backslash
+ *
+ *  Ta \u, \h, \H, \$ den allazoun mesa sto session, opote ginontai text hdh sto
+ *  compile. To cwd krateitai se cache kai ananewnetai mono meta apo cd, opote
+ *  to render den kanei syscalls (ektos apo to \t, pou einai vDSO)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "hy345sh.h"
+
+/* to palio hard-coded prompt: user@-5127-hy345sh:cwd$ */
+#define PS1_DEFAULT "\\u@-5127-hy345sh:\\w$ "
+
+typedef enum
+{
+    SEG_TEXT,     /* seg_text[start, start + len) */
+    SEG_CWD,      /* \w */
+    SEG_CWD_BASE, /* \W */
+    SEG_STATUS,   /* \? */
+    SEG_TIME      /* \t */
+} SegType;
+
+typedef struct
+{
+    SegType type;
+    size_t start;
+    size_t len;
+} PromptSeg;
+
+static PromptSeg *segs = NULL;
+static int nsegs = 0;
+static int segs_cap = 0;
+static StrBuf seg_text;          /* ola ta SEG_TEXT, to ena meta to allo */
+static char *compiled_ps1 = NULL; /* to PS1 apo to opoio vgikan ta segs */
+
+static char user_name[MAX_VAR_NAME];
+static char host_name[256];
+static char cwd_cache[MAX_LINE];
+static int cwd_valid = 0;
+
+/* user kai host mia fora gia olo to session */
+static void prompt_identity(void)
+{
+    if (user_name[0] != '\0')
+    {
+        return;
+    }
+    const char *user = getlogin();
+    snprintf(user_name, sizeof(user_name), "%s", user != NULL ? user : "user");
+    if (gethostname(host_name, sizeof(host_name)) != 0)
+    {
+        strcpy(host_name, "localhost");
+    }
+    host_name[sizeof(host_name) - 1] = '\0';
+}
+
+static void seg_add(SegType type, const char *text, size_t len)
+{
+    /* synexomena text segments enwnontai */
+    if (type == SEG_TEXT && nsegs > 0 && segs[nsegs - 1].type == SEG_TEXT)
+    {
+        sb_append(&seg_text, text, len);
+        segs[nsegs - 1].len += len;
+        return;
+    }
+    if (nsegs == segs_cap)
+    {
+        segs_cap = segs_cap ? segs_cap * 2 : 16;
+        segs = realloc(segs, segs_cap * sizeof(PromptSeg));
+        if (segs == NULL)
+        {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    segs[nsegs].type = type;
+    segs[nsegs].start = seg_text.len;
+    segs[nsegs].len = len;
+    if (len > 0)
+    {
+        sb_append(&seg_text, text, len);
+    }
+    nsegs++;
+}
+
+/*
+ * Metatrepei to PS1 se segments: ta statika escapes ginontai text, ta
+ * dynamika (cwd, status, time) menoun segments
+ */
+static void prompt_compile(const char *ps1)
+{
+    prompt_identity();
+    nsegs = 0;
+    sb_reset(&seg_text);
+    for (const char *p = ps1; *p != '\0'; p++)
+    {
+        if (*p != '\\' || p[1] == '\0')
+        {
+            seg_add(SEG_TEXT, p, 1);
+            continue;
+        }
+        p++;
+        switch (*p)
+        {
+        case 'u':
+            seg_add(SEG_TEXT, user_name, strlen(user_name));
+            break;
+        case 'h':
+            seg_add(SEG_TEXT, host_name, strcspn(host_name, "."));
+            break;
+        case 'H':
+            seg_add(SEG_TEXT, host_name, strlen(host_name));
+            break;
+        case '$':
+            seg_add(SEG_TEXT, geteuid() == 0 ? "#" : "$", 1);
+            break;
+        case 'n':
+            seg_add(SEG_TEXT, "\n", 1);
+            break;
+        case 'w':
+            seg_add(SEG_CWD, NULL, 0);
+            break;
+        case 'W':
+            seg_add(SEG_CWD_BASE, NULL, 0);
+            break;
+        case '?':
+            seg_add(SEG_STATUS, NULL, 0);
+            break;
+        case 't':
+            seg_add(SEG_TIME, NULL, 0);
+            break;
+        default: /* \\ kai agnwsta escapes: o xarakthras opws einai */
+            seg_add(SEG_TEXT, p, 1);
+            break;
+        }
+    }
+    free(compiled_ps1);
+    compiled_ps1 = my_strdup(ps1);
+}
+
+/*
+ * To cwd allaxe (cd): to epomeno render kanei getcwd mia fora
+ */
+void prompt_cwd_changed(void)
+{
+    cwd_valid = 0;
+}
+
+static const char *prompt_cwd(void)
+{
+    if (!cwd_valid)
+    {
+        if (getcwd(cwd_cache, sizeof(cwd_cache)) == NULL)
+        {
+            strcpy(cwd_cache, "uknown");
+        }
+        cwd_valid = 1;
+    }
+    return cwd_cache;
+}
+
+/*
+ * Grafei to prompt sto out (xwris na to typwsei)
+ * To PS1 ksanaginetai compile mono an allaxe apo to prohgoumeno render
+ */
+void prompt_render(StrBuf *out)
+{
+    const char *ps1 = get_Var("PS1");
+    if (ps1 == NULL)
+    {
+        ps1 = PS1_DEFAULT;
+    }
+    if (compiled_ps1 == NULL || strcmp(compiled_ps1, ps1) != 0)
+    {
+        prompt_compile(ps1);
+    }
+
+    sb_reset(out);
+    for (int i = 0; i < nsegs; i++)
+    {
+        const PromptSeg *s = &segs[i];
+        char tmp[24];
+        switch (s->type)
+        {
+        case SEG_TEXT:
+            sb_append(out, seg_text.data + s->start, s->len);
+            break;
+        case SEG_CWD:
+            sb_append(out, prompt_cwd(), strlen(prompt_cwd()));
+            break;
+        case SEG_CWD_BASE:
+        {
+            const char *cwd = prompt_cwd();
+            const char *base = strrchr(cwd, '/');
+            base = base != NULL && base[1] != '\0' ? base + 1 : cwd;
+            sb_append(out, base, strlen(base));
+            break;
+        }
+        case SEG_STATUS:
+            snprintf(tmp, sizeof(tmp), "%d", last_exit_status);
+            sb_append(out, tmp, strlen(tmp));
+            break;
+        case SEG_TIME:
+        {
+            time_t now = time(NULL);
+            struct tm tm;
+            localtime_r(&now, &tm);
+            strftime(tmp, sizeof(tmp), "%H:%M:%S", &tm);
+            sb_append(out, tmp, strlen(tmp));
+            break;
+        }
+        }
+    }
+    if (out->data == NULL)
+    {
+        sb_append(out, "", 0);
+    }
+}
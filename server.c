@@ -0,0 +1,428 @@
+/*
+ *  csd5127: George Kiosklis
+ *  Server mode: hy345sh --server SOCKET
+ *
+ *  Ena shell process akouei se unix socket. Ka8e connection einai ena session:
+ *  o server kanei fork, opote to session klhronomei to zesto state tou server
+ *  (PATH cache, variables) alla oi allages tou (cd, assignments) menoun mesa sto
+ *  session. Polla sessions trexoun tautoxrona, ena process to ka8e ena
+ *
+ *  Protocol (vl. ServerRequest sto hy345sh.h):
+ *    client -> server: header {magic, len} me ta stdin/stdout/stderr tou client
+ *                      san SCM_RIGHTS, meta len bytes "cwd\0command\0"
+ *    server -> client: int32 exit status
+ *  To cwd efarmozetai mono sto prwto request tou session, meta isxyei to cd
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "hy345sh.h"
+
+#define SERVER_MAX_REQUEST (1024 * 1024) /* max mhkos cwd + command */
+
+static volatile sig_atomic_t server_stop = 0;
+
+/* session state gia to on_exit: to exit builtin prepei na steilei kai afto status */
+static int session_sock = -1;
+static pid_t session_pid = 0;
+static int session_busy = 0;
+
+static int send_all(int sock, const void *buf, size_t n)
+{
+    const char *p = buf;
+    while (n > 0)
+    {
+        ssize_t w = send(sock, p, n, MSG_NOSIGNAL);
+        if (w < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        p += w;
+        n -= w;
+    }
+    return 0;
+}
+
+static int recv_all(int sock, void *buf, size_t n)
+{
+    char *p = buf;
+    while (n > 0)
+    {
+        ssize_t r = recv(sock, p, n, 0);
+        if (r < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (r <= 0)
+        {
+            return -1;
+        }
+        p += r;
+        n -= r;
+    }
+    return 0;
+}
+
+/*
+ * Stelnei ena request me ta fds 0, 1, 2 tou caller kai perimenei to status
+ * Returns: 0 se epityxia (to status sto *status), -1 an to connection xa8hke
+ */
+int server_request(int sock, const char *cmd, int *status)
+{
+    char cwd[MAX_LINE];
+    if (getcwd(cwd, sizeof(cwd)) == NULL)
+    {
+        strcpy(cwd, "/");
+    }
+    size_t cwd_len = strlen(cwd) + 1;
+    size_t cmd_len = strlen(cmd) + 1;
+    ServerRequest req = {SERVER_MAGIC, (uint32_t)(cwd_len + cmd_len)};
+    if (req.len > SERVER_MAX_REQUEST)
+    {
+        errno = E2BIG;
+        return -1;
+    }
+
+    int fds[3] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+    union
+    {
+        char buf[CMSG_SPACE(sizeof(fds))];
+        struct cmsghdr align;
+    } control;
+    struct iovec iov = {&req, sizeof(req)};
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cm), fds, sizeof(fds));
+
+    ssize_t w;
+    while ((w = sendmsg(sock, &msg, MSG_NOSIGNAL)) < 0 && errno == EINTR)
+    {
+    }
+    if (w != (ssize_t)sizeof(req) || send_all(sock, cwd, cwd_len) != 0 || send_all(sock, cmd, cmd_len) != 0)
+    {
+        return -1;
+    }
+
+    int32_t reply;
+    if (recv_all(sock, &reply, sizeof(reply)) != 0)
+    {
+        return -1;
+    }
+    *status = reply;
+    return 0;
+}
+
+/*
+ * Syndesh ston server
+ * Returns: to socket h -1 se error
+ */
+int server_connect(const char *path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0)
+    {
+        return -1;
+    }
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+/*
+ * Diavazei ena request: ta 3 fds tou client sto fds[] kai to "cwd\0command\0" sto *payload
+ * Returns: 1 gia request, 0 gia EOF (o client ekleise), -1 se protocol error
+ */
+static int session_recv(int sock, int fds[3], char **payload)
+{
+    ServerRequest req;
+    union
+    {
+        char buf[CMSG_SPACE(3 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct iovec iov = {&req, sizeof(req)};
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    ssize_t r;
+    while ((r = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC | MSG_WAITALL)) < 0 && errno == EINTR)
+    {
+    }
+    if (r == 0)
+    {
+        return 0;
+    }
+
+    int nfds = 0;
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm))
+    {
+        if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS)
+        {
+            nfds = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            memcpy(fds, CMSG_DATA(cm), (nfds < 3 ? nfds : 3) * sizeof(int));
+        }
+    }
+    if (r != (ssize_t)sizeof(req) || req.magic != SERVER_MAGIC || nfds != 3 || req.len < 2 ||
+        req.len > SERVER_MAX_REQUEST || (msg.msg_flags & MSG_CTRUNC))
+    {
+        for (int i = 0; i < nfds && i < 3; i++)
+        {
+            close(fds[i]);
+        }
+        return -1;
+    }
+
+    *payload = malloc(req.len + 1);
+    if (*payload == NULL || recv_all(sock, *payload, req.len) != 0)
+    {
+        free(*payload);
+        for (int i = 0; i < 3; i++)
+        {
+            close(fds[i]);
+        }
+        return -1;
+    }
+    (*payload)[req.len] = '\0';
+    return 1;
+}
+
+static void session_reply(int status)
+{
+    int32_t reply = status;
+    send_all(session_sock, &reply, sizeof(reply));
+}
+
+/* to exit builtin mesa se request: o client pairnei to status tou exit */
+static void session_on_exit(int status, void *arg)
+{
+    (void)arg;
+    if (getpid() == session_pid && session_busy)
+    {
+        fflush(NULL);
+        session_reply(status);
+    }
+}
+
+/*
+ * Ena session: ektelei ta requests enos client me th seira mexri na kleisei to connection
+ * Ta stdin/stdout/stderr tou session ginontai ta fds tou client mono gia th diarkeia
+ * tou request, meta deixnoun sto /dev/null wste o client na vlepei EOF sta pipes tou
+ */
+static void session_run(int sock)
+{
+    int first = 1;
+    session_sock = sock;
+    session_pid = getpid();
+    on_exit(session_on_exit, NULL);
+    stats_init(); /* to shstat enos session metraei mono to session */
+
+    while (1)
+    {
+        int fds[3];
+        char *payload = NULL;
+        int r = session_recv(sock, fds, &payload);
+        if (r <= 0)
+        {
+            if (r < 0)
+            {
+                fprintf(stderr, "hy345sh: bad request from client\n");
+            }
+            break;
+        }
+
+        fflush(NULL);
+        for (int i = 0; i < 3; i++)
+        {
+            dup2(fds[i], i);
+            close(fds[i]);
+        }
+        reader_forget(STDIN_FILENO); /* to lookahead tou prohgoumenou stdin anhkei se allo client fd */
+        char *cwd = payload;
+        char *cmd = payload + strlen(payload) + 1;
+        if (first && chdir(cwd) != 0)
+        {
+            perror("cd");
+        }
+        first = 0;
+
+        session_busy = 1;
+        parse_and_exec(cmd, 0);
+        fflush(NULL);
+        session_busy = 0;
+        free(payload);
+
+        int null = open("/dev/null", O_RDWR);
+        for (int i = 0; i < 3 && null >= 0; i++)
+        {
+            dup2(null, i);
+        }
+        if (null > 2)
+        {
+            close(null);
+        }
+        reader_forget(STDIN_FILENO);
+        session_reply(last_exit_status);
+    }
+    close(sock);
+    exit(0);
+}
+
+static void server_reap(int sig)
+{
+    (void)sig;
+    int saved = errno;
+    while (waitpid(-1, NULL, WNOHANG) > 0)
+    {
+    }
+    errno = saved;
+}
+
+static void server_quit(int sig)
+{
+    (void)sig;
+    server_stop = 1;
+}
+
+/*
+ * Afairei ena palio socket sto path (p.x. apo server pou skotw8hke xwris na kanei unlink)
+ * Opoiodhpote allo arxeio menei ekei pou einai
+ * Returns: 0 an to path einai eleu8ero, -1 se error (EADDRINUSE an den einai socket)
+ */
+static int server_clear_path(const char *path)
+{
+    struct stat st;
+    if (lstat(path, &st) != 0)
+    {
+        return errno == ENOENT ? 0 : -1;
+    }
+    if (!S_ISSOCK(st.st_mode))
+    {
+        errno = EADDRINUSE;
+        return -1;
+    }
+    return unlink(path) == 0 || errno == ENOENT ? 0 : -1;
+}
+
+/*
+ * hy345sh --server SOCKET: accept loop, ena forked session ana connection
+ * Returns: 0 otan stamathsei me SIGINT/SIGTERM, 1 se error
+ */
+int server_run(const char *path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "hy345sh: socket path too long\n");
+        return 1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int lsock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (lsock < 0)
+    {
+        perror("socket");
+        return 1;
+    }
+    struct stat own;
+    if (server_clear_path(path) != 0 || bind(lsock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        lstat(path, &own) != 0 || listen(lsock, 64) != 0)
+    {
+        perror(path);
+        close(lsock);
+        return 1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sa.sa_handler = server_reap;
+    sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &sa, NULL);
+    sa.sa_handler = server_quit;
+    sa.sa_flags = 0; /* xwris SA_RESTART, wste to accept na epistrepsei EINTR */
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    /* to warm-up ginetai mia fora edw, kai ola ta sessions to klhronomoun me to fork */
+    int cached = path_fill();
+    fprintf(stderr, "hy345sh: serving on %s (%d commands in PATH cache)\n", path, cached);
+
+    while (!server_stop)
+    {
+        int sock = accept4(lsock, NULL, NULL, SOCK_CLOEXEC);
+        if (sock < 0)
+        {
+            if (errno != EINTR && errno != ECONNABORTED)
+            {
+                perror("accept");
+                break;
+            }
+            continue;
+        }
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            perror("fork");
+        }
+        else if (pid == 0)
+        {
+            /* to session kanei waitpid sta dika tou children, oxi o handler */
+            signal(SIGCHLD, SIG_DFL);
+            signal(SIGINT, SIG_DFL);
+            signal(SIGTERM, SIG_DFL);
+            close(lsock);
+            session_run(sock);
+        }
+        close(sock);
+    }
+
+    close(lsock);
+    /* mono to socket pou eftiakse to bind parapanw, oxi kati pou mpike sth 8esh tou meta */
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode) && st.st_dev == own.st_dev && st.st_ino == own.st_ino)
+    {
+        unlink(path);
+    }
+    return 0;
+}
@@ -0,0 +1,530 @@
+/*
+ *  csd5127: George Kiosklis
+ *  source builtin kai binary snapshot tou shell state
+ *
+ *  snapshot save FILE [RCFILE] grafei to variable store (scalars kai arrays)
+ *  se ena image pou ginetai mmap sthn ekkinhsh me hy345sh --restore FILE,
+ *  anti na ksanaperasei to rc file apo to parse_and_exec()
+ *
+ *  To image einai position-independent (mono offsets apo thn arxh tou, kanena
+ *  pointer), me magic kai version, kai ginetai apodekto mono an:
+ *    - to header exei to swsto checksum kai to image_size einai to mege8os
+ *      tou arxeiou, kai oi pinakes tou header einai mesa sto arxeio
+ *    - to RCFILE exei to idio mtime kai size, h (an allaxe to mtime) to idio
+ *      hash periexomenou
+ *  Alliws to --restore kanei source to RCFILE kai ksanagrafei to snapshot
+ *
+ *  To restore den ftiaxnei ta variables: to mapping menei anoixto kai ginetai
+ *  to backing tou variable table (vl. vars_attach). To image exei etoimo hash
+ *  index twn onomatwn, opote ena variable vrisketai xwris na diavastei olo to
+ *  image, kai ginetai Var (me ta values mesa sto mapping) mono otan xrhsimopoih8ei
+ *  Ka8e record elegxetai (oria, vector) otan diavazetai. Ta arrays apo8hkeyontai
+ *  me to idio vector format pou exoun sth mnhmh (vl. vars.c)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "hy345sh.h"
+
+#define SNAP_MAGIC "HY3SNAP1"
+#define SNAP_VERSION 2
+
+/*
+ * Header tou image, sthn arxh tou arxeiou. Ola ta *_off einai offsets apo
+ * thn arxh tou image
+ */
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;  /* sizeof(SnapHeader) tou writer */
+    uint64_t image_size;   /* olo to arxeio */
+    uint64_t header_hash;  /* FNV-1a tou header me header_hash = 0 */
+    uint64_t rc_mtime_ns;  /* 0 an to snapshot den exei rc file */
+    uint64_t rc_size;
+    uint64_t rc_hash;      /* FNV-1a tou periexomenou tou rc file */
+    uint64_t var_bytes;    /* onomata kai values olwn twn variables (var_stats) */
+    uint32_t rc_path_off;  /* NUL-terminated path, 0 an den yparxei */
+    uint32_t nvars;
+    uint32_t vars_off;     /* nvars * SnapVar */
+    uint32_t index_off;    /* index_size * uint32: i + 1 tou SnapVar, 0 = keno */
+    uint32_t index_size;   /* dynamh tou 2, >= 2 * nvars (open addressing) */
+    uint32_t reserved;
+} SnapHeader;
+
+typedef struct
+{
+    uint32_t name_off;   /* NUL-terminated */
+    uint32_t value_off;  /* scalar: NUL-terminated, array: to vector */
+    uint32_t value_len;  /* bytes tou value (xwris to '\0' gia scalar) */
+    uint32_t count;      /* plh8os elements, 0 gia scalar */
+    uint32_t is_array;
+    uint32_t reserved;
+} SnapVar;
+
+static uint64_t fnv64(uint64_t h, const void *data, size_t n)
+{
+    const unsigned char *p = data;
+    for (size_t i = 0; i < n; i++)
+    {
+        h = (h ^ p[i]) * 1099511628211ULL;
+    }
+    return h;
+}
+
+#define FNV_INIT 14695981039346656037ULL
+
+/* checksum tou header (me to pedio tou checksum 0) */
+static uint64_t header_hash(const SnapHeader *h)
+{
+    SnapHeader copy = *h;
+    copy.header_hash = 0;
+    return fnv64(FNV_INIT, &copy, sizeof(copy));
+}
+
+/* hash enos onomatos gia to index tou image */
+static uint64_t name_hash(const char *name)
+{
+    return fnv64(FNV_INIT, name, strlen(name));
+}
+
+/*
+ * Hash tou periexomenou enos arxeiou (mesw mmap)
+ * Returns: 0 se epityxia, -1 an den diavazetai
+ */
+static int file_hash(const char *path, uint64_t *hash)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat sb;
+    if (fd < 0 || fstat(fd, &sb) != 0)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    *hash = FNV_INIT;
+    if (sb.st_size > 0)
+    {
+        void *p = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            close(fd);
+            return -1;
+        }
+        *hash = fnv64(*hash, p, sb.st_size);
+        munmap(p, sb.st_size);
+    }
+    close(fd);
+    return 0;
+}
+
+static uint64_t mtime_ns(const struct stat *sb)
+{
+    return (uint64_t)sb->st_mtim.tv_sec * 1000000000ULL + sb->st_mtim.tv_nsec;
+}
+
+/*
+ * Ektelei ena script mesa sto trexon shell (source FILE)
+ * Returns: to exit status tou teleftaiou command, -1 (me errno) an den anoigei
+ */
+int source_file(const char *path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    /* diko tou Reader, oxi sto registry: to fd kleinei meta */
+    Reader *r = malloc(sizeof(Reader));
+    if (r == NULL)
+    {
+        close(fd);
+        return -1;
+    }
+    reader_init(r, fd);
+    StrBuf cmd;
+    sb_init(&cmd);
+    last_exit_status = 0;
+    while (read_complete_cmd(r, &cmd))
+    {
+        parse_and_exec(cmd.data, 0);
+    }
+    sb_free(&cmd);
+    free(r);
+    close(fd);
+    return last_exit_status;
+}
+
+/*
+ * source FILE
+ * Returns: exit status
+ */
+int builtin_source(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: source FILE\n");
+        return 2;
+    }
+    int status = source_file(argv[1]);
+    if (status < 0)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    return status;
+}
+
+/* append ston StrBuf me padding se 8 bytes, returns to offset */
+static uint32_t image_add(StrBuf *img, const void *data, size_t n)
+{
+    static const char zeros[8] = {0};
+    uint32_t off = (uint32_t)img->len;
+    if (n > 0)
+    {
+        sb_append(img, data, n);
+    }
+    if (img->len % 8 != 0)
+    {
+        sb_append(img, zeros, 8 - img->len % 8);
+    }
+    return off;
+}
+
+/*
+ * Grafei to snapshot tou variable store sto path (atomic me rename)
+ * rc: to rc file pou perigrafei to snapshot (NULL an den yparxei)
+ * Returns: 0 se epityxia, -1 (me mhnyma) se error
+ */
+int snapshot_save(const char *path, const char *rc)
+{
+    SnapHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAP_MAGIC, 8);
+    h.version = SNAP_VERSION;
+    h.header_size = sizeof(SnapHeader);
+
+    StrBuf img;
+    sb_init(&img);
+    image_add(&img, &h, sizeof(h));
+
+    if (rc != NULL)
+    {
+        /* absolute path, wste to --restore na douleyei apo opoiodhpote directory */
+        struct stat sb;
+        char *full = realpath(rc, NULL);
+        if (full == NULL || stat(full, &sb) != 0 || file_hash(full, &h.rc_hash) != 0)
+        {
+            perror(rc);
+            free(full);
+            sb_free(&img);
+            return -1;
+        }
+        h.rc_mtime_ns = mtime_ns(&sb);
+        h.rc_size = sb.st_size;
+        h.rc_path_off = image_add(&img, full, strlen(full) + 1);
+        free(full);
+    }
+
+    /* prwta o pinakas twn SnapVar kai to index (gemizoun meta), meta names kai values */
+    vars_load_all();
+    h.nvars = var_count;
+    h.vars_off = image_add(&img, NULL, 0);
+    SnapVar empty;
+    memset(&empty, 0, sizeof(empty));
+    for (int i = 0; i < var_count; i++)
+    {
+        image_add(&img, &empty, sizeof(empty));
+    }
+    h.index_size = 8;
+    while (h.index_size < 2 * h.nvars)
+    {
+        h.index_size *= 2;
+    }
+    h.index_off = image_add(&img, NULL, 0);
+    for (uint32_t i = 0; i < h.index_size; i++)
+    {
+        uint32_t slot = 0;
+        sb_append(&img, (const char *)&slot, sizeof(slot));
+    }
+    image_add(&img, NULL, 0);
+    for (int i = 0; i < var_count; i++)
+    {
+        const Var *v = variable[i];
+        SnapVar sv;
+        memset(&sv, 0, sizeof(sv));
+        sv.name_off = image_add(&img, v->name, strlen(v->name) + 1);
+        sv.is_array = v->is_array;
+        if (v->is_array)
+        {
+            sv.count = v->count;
+            sv.value_len = v->elems.len;
+            sv.value_off = image_add(&img, v->elems.data, v->elems.len);
+        }
+        else
+        {
+            sv.value_len = strlen(v->value);
+            sv.value_off = image_add(&img, v->value, sv.value_len + 1);
+        }
+        h.var_bytes += strlen(v->name) + sv.value_len;
+        memcpy(img.data + h.vars_off + i * sizeof(SnapVar), &sv, sizeof(sv));
+
+        uint32_t *slots = (uint32_t *)(img.data + h.index_off);
+        uint32_t mask = h.index_size - 1;
+        uint32_t k = name_hash(v->name) & mask;
+        while (slots[k] != 0)
+        {
+            k = (k + 1) & mask;
+        }
+        slots[k] = i + 1;
+    }
+
+    h.image_size = img.len;
+    h.header_hash = header_hash(&h);
+    memcpy(img.data, &h, sizeof(h));
+
+    char tmp[MAX_LINE + 32];
+    snprintf(tmp, sizeof(tmp), "%s.tmp.%d", path, (int)getpid());
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    size_t off = 0;
+    while (fd >= 0 && off < img.len)
+    {
+        ssize_t w = write(fd, img.data + off, img.len - off);
+        if (w < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (w <= 0)
+        {
+            break;
+        }
+        off += w;
+    }
+    int ok = fd >= 0 && off == img.len;
+    if (fd >= 0 && close(fd) != 0)
+    {
+        ok = 0;
+    }
+    sb_free(&img);
+    if (!ok || rename(tmp, path) != 0)
+    {
+        perror(path);
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+/* to vector enos array: count elements pou gemizoun akrivws ta len bytes */
+static int image_vector_ok(const char *vec, uint32_t len, uint32_t count)
+{
+    size_t off = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t n;
+        if (off + sizeof(n) > len)
+        {
+            return 0;
+        }
+        memcpy(&n, vec + off, sizeof(n));
+        off += sizeof(n) + (size_t)n + 1;
+        if (off > len || vec[off - 1] != '\0')
+        {
+            return 0;
+        }
+    }
+    return off == len;
+}
+
+/* ena NUL-terminated string mesa sto image */
+static int image_str_ok(const char *base, uint64_t size, uint32_t off)
+{
+    return off < size && memchr(base + off, '\0', size - off) != NULL;
+}
+
+/*
+ * Elegxei to header tou image (checksum, mege8os, oria twn pinakwn) kai an to
+ * rc file einai akoma to idio. Ta records twn variables elegxontai otan
+ * diavazontai (snap_lookup), opote o elegxos den exartatai apo to plh8os tous
+ * Returns: 1 an isxyei, 0 an to rc allaxe (to path tou sto *rc), -1 an einai xalasmeno
+ */
+static int snapshot_check(const char *base, uint64_t size, const char **rc)
+{
+    const SnapHeader *h = (const SnapHeader *)base;
+    *rc = NULL;
+    if (size < sizeof(SnapHeader) || memcmp(h->magic, SNAP_MAGIC, 8) != 0 || h->version != SNAP_VERSION ||
+        h->header_size != sizeof(SnapHeader) || h->image_size != size || h->header_hash != header_hash(h))
+    {
+        return -1;
+    }
+    if ((uint64_t)h->vars_off + (uint64_t)h->nvars * sizeof(SnapVar) > size || h->vars_off % 8 != 0 ||
+        (uint64_t)h->index_off + (uint64_t)h->index_size * sizeof(uint32_t) > size || h->index_off % 8 != 0 ||
+        h->index_size < 2 * (uint64_t)h->nvars || (h->index_size & (h->index_size - 1)) != 0)
+    {
+        return -1;
+    }
+    if (h->rc_path_off == 0)
+    {
+        return 1;
+    }
+    if (!image_str_ok(base, size, h->rc_path_off))
+    {
+        return -1;
+    }
+
+    /* grhgoro check me mtime kai size, to hash mono an allaxe to mtime (p.x. touch) */
+    *rc = base + h->rc_path_off;
+    struct stat sb;
+    uint64_t hash;
+    if (stat(*rc, &sb) != 0 || (uint64_t)sb.st_size != h->rc_size)
+    {
+        return 0;
+    }
+    if (mtime_ns(&sb) == h->rc_mtime_ns)
+    {
+        return 1;
+    }
+    return file_hash(*rc, &hash) == 0 && hash == h->rc_hash;
+}
+
+/* to snapshot pou fortw8hke (to mapping den kleinei pote, ta Var deixnoun mesa tou) */
+static const char *snap_base = NULL;
+static uint64_t snap_size = 0;
+
+static const SnapHeader *snap_header(void)
+{
+    return (const SnapHeader *)snap_base;
+}
+
+/* to onoma tou record i, NULL an einai ektos oriwn */
+static const char *snap_name_at(uint32_t i)
+{
+    if (i >= snap_header()->nvars)
+    {
+        return NULL;
+    }
+    const SnapVar *sv = (const SnapVar *)(snap_base + snap_header()->vars_off) + i;
+    return image_str_ok(snap_base, snap_size, sv->name_off) ? snap_base + sv->name_off : NULL;
+}
+
+/*
+ * Vriskei to name sto index tou image kai elegxei to record tou
+ * Returns: 1 me to variable sto *out, 0 an den yparxei (h einai xalasmeno)
+ */
+static int snap_lookup(const char *name, VarImage *out)
+{
+    const SnapHeader *h = snap_header();
+    const uint32_t *slots = (const uint32_t *)(snap_base + h->index_off);
+    const SnapVar *vars = (const SnapVar *)(snap_base + h->vars_off);
+    uint32_t mask = h->index_size - 1;
+    uint32_t k = name_hash(name) & mask;
+    for (uint32_t probes = 0; probes < h->index_size && slots[k] != 0; probes++, k = (k + 1) & mask)
+    {
+        const char *vname = slots[k] <= h->nvars ? snap_name_at(slots[k] - 1) : NULL;
+        if (vname == NULL || strcmp(vname, name) != 0)
+        {
+            continue;
+        }
+        const SnapVar *sv = &vars[slots[k] - 1];
+        if ((uint64_t)sv->value_off + sv->value_len > snap_size ||
+            (!sv->is_array && (sv->value_len >= snap_size - sv->value_off || snap_base[sv->value_off + sv->value_len] != '\0')) ||
+            (sv->is_array && !image_vector_ok(snap_base + sv->value_off, sv->value_len, sv->count)))
+        {
+            fprintf(stderr, "hy345sh: snapshot: bad record for %s\n", name);
+            return 0;
+        }
+        out->value = snap_base + sv->value_off;
+        out->len = sv->value_len;
+        out->is_array = sv->is_array != 0;
+        out->count = sv->count;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * hy345sh --restore FILE: to variable store apo to snapshot (ws backing, vl. vars_attach)
+ * An to rc file tou snapshot allaxe kanei source to rc kai ksanagrafei to
+ * snapshot. Ena xalasmeno image den fortwnetai ka8olou
+ * Returns: 0 se epityxia, 1 se error
+ */
+int snapshot_restore(const char *path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat sb;
+    if (fd < 0 || fstat(fd, &sb) != 0 || sb.st_size == 0)
+    {
+        perror(path);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return 1;
+    }
+    char *base = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        perror(path);
+        return 1;
+    }
+
+    const char *rc;
+    int valid = snapshot_check(base, sb.st_size, &rc);
+    if (valid <= 0)
+    {
+        char *rc_copy = rc != NULL ? my_strdup(rc) : NULL;
+        munmap(base, sb.st_size);
+        if (rc_copy == NULL)
+        {
+            fprintf(stderr, "hy345sh: %s: invalid snapshot\n", path);
+            return 1;
+        }
+        /* to rc allaxe: source kai neo snapshot gia thn epomenh ekkinhsh */
+        int status = source_file(rc_copy);
+        if (status < 0)
+        {
+            perror(rc_copy);
+        }
+        else
+        {
+            snapshot_save(path, rc_copy);
+        }
+        free(rc_copy);
+        return status < 0;
+    }
+
+    /* to variable table diavazei apo to image, to mapping menei */
+    snap_base = base;
+    snap_size = sb.st_size;
+    VarBacking b;
+    b.lookup = snap_lookup;
+    b.name_at = snap_name_at;
+    b.count = snap_header()->nvars;
+    b.bytes = snap_header()->var_bytes;
+    vars_attach(&b);
+    return 0;
+}
+
+/*
+ * snapshot save FILE [RCFILE]
+ * Returns: exit status
+ */
+int builtin_snapshot(int argc, char **argv)
+{
+    if (argc < 3 || argc > 4 || strcmp(argv[1], "save") != 0)
+    {
+        fprintf(stderr, "usage: snapshot save FILE [RCFILE]\n");
+        return 2;
+    }
+    return snapshot_save(argv[2], argc > 3 ? argv[3] : NULL) == 0 ? 0 : 1;
+}
@@ -0,0 +1,295 @@
+/*
+ *  csd5127: George Kiosklis
+ *  Runtime counters (shstat builtin kai SIGUSR1 snapshot)
+ *
+ *  Oi counters einai se MAP_SHARED anonymous mmap, opote kai ta forked children
+ *  metrane (p.x. exec failures) me atomic adds xwris allo IPC. Ka8e hook einai
+ *  ena atomic add h ena clock_gettime (vDSO), opote menoun panta energa
+ *
+ *  To SIGUSR1 grafei to snapshot kateu8eian apo ton handler: to format ginetai
+ *  xwris stdio/malloc (mono write/open), ara den xreiazetai polling sto main loop
+ *  Gi' afto ola ta pedia einai hdh etoimoi counters: to megethos twn variables
+ *  to krataei to vars.c (var_stats), to peak twn children to wait4 (vl. wait.c)
+ *  kai to peak tou shell diavazetai apo to /proc/self/status, xwris getrusage
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#include "hy345sh.h"
+
+#define STAT_BUF_MAX 2048
+
+/* mexri to stats_init oi counters einai topikoi (p.x. sto bench) */
+static ShellStats local_stats;
+ShellStats *shstat = &local_stats;
+VarStats *var_stats = &local_stats.var;
+static VarStats child_var_stats; /* ta variables enos forked child (stats_forked) */
+
+static char stat_file[MAX_LINE]; /* pou grafei to SIGUSR1 */
+static uint64_t start_ns = 0;
+
+uint64_t stats_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Async-signal-safe format: apla appends se fixed buffer
+ */
+typedef struct
+{
+    char data[STAT_BUF_MAX];
+    size_t len;
+} StatBuf;
+
+static void put_str(StatBuf *b, const char *s)
+{
+    while (*s != '\0' && b->len < STAT_BUF_MAX - 1)
+    {
+        b->data[b->len++] = *s++;
+    }
+}
+
+static void put_u64(StatBuf *b, uint64_t v)
+{
+    char tmp[24];
+    int n = 0;
+    do
+    {
+        tmp[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v > 0);
+    while (n > 0 && b->len < STAT_BUF_MAX - 1)
+    {
+        b->data[b->len++] = tmp[--n];
+    }
+}
+
+/* ns se "sec.millis" */
+static void put_secs(StatBuf *b, uint64_t ns)
+{
+    put_u64(b, ns / 1000000000ULL);
+    put_str(b, ".");
+    uint64_t ms = ns / 1000000ULL % 1000;
+    put_str(b, ms < 100 ? (ms < 10 ? "00" : "0") : "");
+    put_u64(b, ms);
+}
+
+/* ena pedio: "name": value se JSON, "name: value" se text */
+static void put_field(StatBuf *b, int json, const char *name, uint64_t v, int secs)
+{
+    put_str(b, json ? (b->len > 1 ? ",\n  \"" : "\n  \"") : "");
+    put_str(b, name);
+    put_str(b, json ? "\": " : ": ");
+    if (secs)
+    {
+        put_secs(b, v);
+    }
+    else
+    {
+        put_u64(b, v);
+    }
+    put_str(b, json ? "" : "\n");
+}
+
+static uint64_t load(const uint64_t *p)
+{
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+/* xronos pou exei mazepsei o counter, mazi me to kommati pou trexei twra */
+static uint64_t load_time(const uint64_t *total, const uint64_t *since, uint64_t now)
+{
+    uint64_t start = load(since);
+    return load(total) + (start != 0 && now > start ? now - start : 0);
+}
+
+/*
+ * Peak resident memory tou shell (VmHWM, idio me to ru_maxrss) se kB
+ * Mono open/read, ara ginetai kai mesa ston SIGUSR1 handler
+ */
+static uint64_t self_maxrss_kb(void)
+{
+    char buf[4096];
+    int fd = open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return 0;
+    }
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    buf[n > 0 ? n : 0] = '\0';
+    const char *p = strstr(buf, "VmHWM:");
+    uint64_t kb = 0;
+    for (p = p != NULL ? p + 6 : ""; *p == ' ' || *p == '\t'; p++)
+    {
+    }
+    for (; *p >= '0' && *p <= '9'; p++)
+    {
+        kb = kb * 10 + (*p - '0');
+    }
+    return kb;
+}
+
+/*
+ * Snapshot olwn twn counters se text h JSON
+ * Diavazei mono etoimous counters (kanena walk sta variables), ara einai async-signal-safe
+ */
+static void stats_format(StatBuf *b, int json)
+{
+    uint64_t now = stats_now_ns();
+
+    b->len = 0;
+    put_str(b, json ? "{" : "");
+    put_field(b, json, "pid", (uint64_t)getpid(), 0);
+    put_field(b, json, "uptime_s", now - start_ns, 1);
+    put_field(b, json, "commands", load(&shstat->commands), 0);
+    put_field(b, json, "builtins", load(&shstat->builtins), 0);
+    put_field(b, json, "externals", load(&shstat->externals), 0);
+    put_field(b, json, "assignments", load(&shstat->assignments), 0);
+    put_field(b, json, "pipelines", load(&shstat->pipelines), 0);
+    put_field(b, json, "forks", load(&shstat->forks), 0);
+    put_field(b, json, "execs", load(&shstat->execs), 0);
+    put_field(b, json, "exec_failures", load(&shstat->exec_failures), 0);
+    put_field(b, json, "exec_time_s", load_time(&shstat->exec_ns, &shstat->exec_since, now), 1);
+    put_field(b, json, "parse_time_s", load(&shstat->parse_ns), 1);
+    put_field(b, json, "wait_time_s", load_time(&shstat->wait_ns, &shstat->wait_since, now), 1);
+    put_field(b, json, "vars", var_stats->vars, 0);
+    put_field(b, json, "var_bytes", var_stats->var_bytes, 0);
+    put_field(b, json, "maxrss_kb", self_maxrss_kb(), 0);
+    put_field(b, json, "children_maxrss_kb", load(&shstat->children_maxrss_kb), 0);
+    put_field(b, json, "cache_hits", load(&shstat->cache_hits), 0);
+    put_field(b, json, "cache_misses", load(&shstat->cache_misses), 0);
+    put_field(b, json, "cache_stores", load(&shstat->cache_stores), 0);
+    put_field(b, json, "cache_evictions", load(&shstat->cache_evictions), 0);
+    put_str(b, json ? "\n}\n" : "");
+}
+
+static void write_buf(int fd, const StatBuf *b)
+{
+    size_t off = 0;
+    while (off < b->len)
+    {
+        ssize_t w = write(fd, b->data + off, b->len - off);
+        if (w < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (w <= 0)
+        {
+            break;
+        }
+        off += w;
+    }
+}
+
+/* SIGUSR1: JSON snapshot sto stat_file (mono async-signal-safe calls) */
+static void stats_signal(int sig)
+{
+    (void)sig;
+    int saved = errno;
+    StatBuf b;
+    stats_format(&b, 1);
+    int fd = open(stat_file, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd >= 0)
+    {
+        write_buf(fd, &b);
+        close(fd);
+    }
+    errno = saved;
+}
+
+/*
+ * Nea (mhdenismena) shared counters gia afto to process kai ta children tou,
+ * kai o SIGUSR1 handler. To snapshot file einai $HY345SH_STAT_FILE
+ * h /tmp/hy345sh-stat.<pid>.json
+ */
+void stats_init(void)
+{
+    VarStats vars = *var_stats; /* ta variables yparxoun hdh, mono oi counters ksekinoun apo 0 */
+    void *p = mmap(NULL, sizeof(ShellStats), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p != MAP_FAILED)
+    {
+        shstat = p; /* to prohgoumeno mapping (an yphrxe) menei gia ton parent */
+    }
+    else
+    {
+        memset(&local_stats, 0, sizeof(local_stats));
+        shstat = &local_stats;
+    }
+    shstat->var = vars;
+    var_stats = &shstat->var;
+    start_ns = stats_now_ns();
+
+    const char *env = getenv("HY345SH_STAT_FILE");
+    if (env != NULL && *env != '\0')
+    {
+        snprintf(stat_file, sizeof(stat_file), "%s", env);
+    }
+    else
+    {
+        snprintf(stat_file, sizeof(stat_file), "/tmp/hy345sh-stat.%d.json", (int)getpid());
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = stats_signal;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGUSR1, &sa, NULL);
+}
+
+/*
+ * Sto child meta to fork, an 8a trexei shell code (pipeline stage, subshell):
+ * oi counters menoun shared, ta variables tou child omws einai pleon dika tou
+ */
+void stats_forked(void)
+{
+    child_var_stats = *var_stats;
+    var_stats = &child_var_stats;
+}
+
+/* ena child pou egine reap: krataei to megalytero ru_maxrss */
+void stats_child_maxrss(uint64_t kb)
+{
+    uint64_t cur = load(&shstat->children_maxrss_kb);
+    while (kb > cur &&
+           !__atomic_compare_exchange_n(&shstat->children_maxrss_kb, &cur, kb, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+/*
+ * shstat [-j]: oi counters sto stdout se text h JSON
+ * Returns: exit status
+ */
+int builtin_shstat(int argc, char **argv)
+{
+    int json = argc > 1 && strcmp(argv[1], "-j") == 0;
+    if (argc > 1 && !json)
+    {
+        fprintf(stderr, "usage: shstat [-j]\n");
+        return 2;
+    }
+    StatBuf b;
+    stats_format(&b, json);
+    fwrite(b.data, 1, b.len, stdout);
+    if (!json)
+    {
+        uint64_t builtins = load(&shstat->builtins) + load(&shstat->assignments);
+        uint64_t total = builtins + load(&shstat->externals);
+        printf("builtin ratio: %.1f%%\n", total > 0 ? 100.0 * builtins / total : 0.0);
+    }
+    fflush(stdout);
+    return 0;
+}
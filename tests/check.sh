@@ -0,0 +1,56 @@
+#!/bin/sh
+#  csd5127: George Kiosklis
+#  Regression checks gia to hy345sh (make check)
+#  Ka8e check typwnei "ok" h "FAIL" kai to exit status einai 1 an apetyxe estw ena
+
+cd "$(dirname "$0")/.." || exit 1
+SHELL_BIN=./hy345sh
+TMP=$(mktemp -d /tmp/hy345sh-check.XXXXXX)
+trap 'rm -rf "$TMP"' EXIT
+failed=0
+
+result()
+{
+    if [ "$1" -eq 0 ]; then
+        printf 'ok    %s\n' "$2"
+    else
+        printf 'FAIL  %s\n' "$2"
+        failed=1
+    fi
+}
+
+# server: to deftero request diavazei to diko tou stdin, oxi to lookahead tou prwtou
+./tests/server_stdin "$SHELL_BIN" "$TMP/sock"
+result $? "server: read in consecutive requests uses each request's stdin"
+
+# timeout: to deadline ftanei kai sta processes pou xekinhse to stage
+# (to sleep einai paidi tou sh / tou { } child, oxi stage tou pipeline)
+no_survivor()
+{
+    sleep 0.2
+    ! pgrep -f "^sleep $1" > /dev/null
+}
+printf 'sleep $1\ntrue\n' > "$TMP/child.sh"
+$SHELL_BIN -c "timeout 0.3 sh $TMP/child.sh 7.301"
+no_survivor 7.301
+result $? "timeout: no descendant of a script stage survives"
+$SHELL_BIN -c "timeout 0.3 { sleep 7.302; true; }"
+no_survivor 7.302
+result $? "timeout: no descendant of a { } stage survives"
+$SHELL_BIN -c "timeout 0.3 sh $TMP/child.sh 7.303 | cat"
+no_survivor 7.303
+result $? "timeout: no descendant of a pipeline stage survives"
+
+# cached: ena kommeno entry einai miss (xwris miso output) kai xanagrafetai,
+# kai oi counters metrane kai ta cached pou trexoun san pipeline stage
+export HY345SH_CACHE_DIR="$TMP/cache"
+$SHELL_BIN -c "cached seq 3" > /dev/null
+entry=$(ls "$TMP"/cache/*.out)
+truncate -s 27 "$entry" # header 24 bytes, body "1\n2\n3\n"
+out=$($SHELL_BIN -c "cached seq 3")
+[ "$out" = "$(seq 3)" ] && [ "$(wc -c < "$entry")" -eq 30 ]
+result $? "cached: a truncated entry is re-run and stored again"
+$SHELL_BIN -c "cached seq 3 | cat; cached seq 4 | cat; cached --stats" | grep -q "hits: 1 misses: 1"
+result $? "cached: hits and misses in pipeline stages are counted"
+
+exit $failed
@@ -0,0 +1,81 @@
+/*
+ *  csd5127: George Kiosklis
+ *  Check gia to server mode: dyo requests sto idio session me diaforetiko
+ *  stdin to ka8e ena. To read tou prwtou request gemizei to lookahead buffer
+ *  tou fd 0 me ola ta bytes tou pipe, kai to deftero request prepei na
+ *  diavasei apo to diko tou stdin, oxi ta ypoloipa tou prwtou
+ *
+ *  Usage: server_stdin SHELL SOCKET   (xekinaei to "SHELL --server SOCKET")
+ *  Exit status: 0 an perase, 1 an oxi
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/wait.h>
+
+#include "hy345sh.h"
+
+/*
+ * Stelnei to cmd me stdin ena pipe pou periexei to input (kai meta EOF)
+ * Returns: to exit status tou cmd, -1 an xa8hke to connection
+ */
+static int request_with_stdin(int sock, const char *cmd, const char *input)
+{
+    int p[2], status;
+    if (pipe(p) != 0 || write(p[1], input, strlen(input)) != (ssize_t)strlen(input))
+    {
+        return -1;
+    }
+    close(p[1]);
+    int saved = dup(STDIN_FILENO);
+    dup2(p[0], STDIN_FILENO);
+    close(p[0]);
+    int r = server_request(sock, cmd, &status);
+    dup2(saved, STDIN_FILENO);
+    close(saved);
+    return r == 0 ? status : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: %s SHELL SOCKET\n", argv[0]);
+        return 1;
+    }
+    pid_t server = fork();
+    if (server == 0)
+    {
+        execl(argv[1], argv[1], "--server", argv[2], (char *)NULL);
+        perror(argv[1]);
+        _exit(127);
+    }
+
+    int sock = -1;
+    for (int i = 0; i < 200 && sock < 0; i++)
+    {
+        struct timespec ts = {0, 10 * 1000 * 1000};
+        nanosleep(&ts, NULL);
+        sock = server_connect(argv[2]);
+    }
+    int first = -1, second = -1;
+    if (sock >= 0)
+    {
+        first = request_with_stdin(sock, "read a; [ $a = one ]", "one\ntwo\n");
+        second = request_with_stdin(sock, "read b; [ $b = AAA ]", "AAA\n");
+        close(sock);
+    }
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+
+    if (first != 0 || second != 0)
+    {
+        fprintf(stderr, "server_stdin: read got the wrong line (status %d, %d)\n", first, second);
+        return 1;
+    }
+    return 0;
+}
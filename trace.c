@@ -0,0 +1,200 @@
+/*
+ *  csd5127: George Kiosklis
+ *  Execution tracing
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#include "hy345sh.h"
+
+/*
+ * Execution tracing se Chrome trace-event JSON format (fortwnei sto Perfetto / chrome://tracing)
+ * Ka8e event grafetai me ena write() se fd anoigmeno me O_APPEND, wste ta children
+ * meta to fork na mporoun na grafoun sto idio arxeio xwris na mperdeyontai ta buffers
+ * Otan to tracing einai off to trace_fd einai -1 kai ka8e hook kostizei ena branch
+ */
+int trace_fd = -1;
+pid_t trace_pid = 0; /* pid tou shell pou anoixe to trace (to "process" sto trace) */
+
+/* Timestamp se microseconds (monotonic) */
+static double trace_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/*
+ * Grafei to s san JSON string (xwris ta quotes) sto out
+ * Kovei to string an den xwraei
+ */
+static void trace_json_escape(char *out, size_t size, const char *s)
+{
+    size_t j = 0;
+    for (; s != NULL && *s != '\0' && j + 7 < size; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+        {
+            out[j++] = '\\';
+            out[j++] = c;
+        }
+        else if (c < 0x20)
+        {
+            j += snprintf(out + j, size - j, "\\u%04x", c);
+        }
+        else
+        {
+            out[j++] = c;
+        }
+    }
+    out[j] = '\0';
+}
+
+/*
+ * Grafei ena event sto trace
+ * ph: B/E (span), i (instant), tid: to "thread" track (shell pid h child pid)
+ * args: hdh formatted JSON object h NULL
+ */
+static void trace_write(char ph, const char *name, const char *cat, pid_t tid, const char *args)
+{
+    char ev[TRACE_EVENT_MAX + 256];
+    char esc_name[256];
+    trace_json_escape(esc_name, sizeof(esc_name), name);
+    int n = snprintf(ev, sizeof(ev),
+                     ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",%s\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":%s}",
+                     esc_name, cat, ph, ph == 'i' ? "\"s\":\"t\"," : "", trace_now_us(),
+                     (int)trace_pid, (int)tid, args != NULL ? args : "{}");
+    if (n > (int)sizeof(ev) - 1)
+    {
+        n = sizeof(ev) - 1;
+    }
+    if (write(trace_fd, ev, n) < 0)
+    {
+        /* to trace einai best-effort */
+    }
+}
+
+/*
+ * Span gia parse/expansion sto track tou shell
+ */
+void trace_span(char ph, const char *name, const char *text)
+{
+    char esc[TRACE_EVENT_MAX / 2];
+    char args[TRACE_EVENT_MAX];
+    trace_json_escape(esc, sizeof(esc), text);
+    snprintf(args, sizeof(args), "{\"text\":\"%s\"}", esc);
+    trace_write(ph, name, "shell", getpid(), args);
+}
+
+/*
+ * Process events: fork, exec, exec_error, exit
+ * To fork anoigei ena span sto track tou child (tid = child pid) kai to exit to kleinei,
+ * opote to Perfetto deixnei th diarkeia zwhs ka8e child
+ */
+void trace_proc(const char *event, pid_t pid, int stage, const char *cmd, int status)
+{
+    char esc[TRACE_EVENT_MAX / 2];
+    char args[TRACE_EVENT_MAX];
+    trace_json_escape(esc, sizeof(esc), cmd);
+    snprintf(args, sizeof(args), "{\"pid\":%d,\"stage\":%d,\"argv\":\"%s\",\"status\":%d}",
+             (int)pid, stage, esc, status);
+    trace_write('i', event, "process", pid, args);
+    if (strcmp(event, "fork") == 0)
+    {
+        trace_write('B', cmd, "process", pid, args);
+    }
+    else if (strcmp(event, "exit") == 0)
+    {
+        trace_write('E', cmd, "process", pid, args);
+    }
+}
+
+/*
+ * Enwnei ta argv se ena string gia ta trace events
+ */
+static void trace_join_argv(char *out, size_t size, char **argv)
+{
+    size_t j = 0;
+    out[0] = '\0';
+    for (int i = 0; argv[i] != NULL && j + 1 < size; i++)
+    {
+        j += snprintf(out + j, size - j, i > 0 ? " %s" : "%s", argv[i]);
+    }
+}
+
+/* fork event apo ton parent, me ta argv tou child */
+void trace_fork(pid_t pid, int stage, char **argv)
+{
+    char cmd[TRACE_EVENT_MAX / 2];
+    trace_join_argv(cmd, sizeof(cmd), argv);
+    trace_proc("fork", pid, stage, cmd, 0);
+}
+
+/* exec event, grafetai apo to idio to child akrivws prin to execvp */
+void trace_exec(int stage, char **argv)
+{
+    char cmd[TRACE_EVENT_MAX / 2];
+    trace_join_argv(cmd, sizeof(cmd), argv);
+    trace_proc("exec", getpid(), stage, cmd, 0);
+}
+
+/* exit event otan o parent kanei reap to child */
+void trace_exit(pid_t pid, int stage, char **argv, int status)
+{
+    char cmd[TRACE_EVENT_MAX / 2];
+    trace_join_argv(cmd, sizeof(cmd), argv);
+    trace_proc("exit", pid, stage, cmd, status_code(status));
+}
+
+/*
+ * Kleinei to JSON array kai to arxeio tou trace
+ * Se forked child (p.x. exit mesa se subshell) kleinei mono to fd,
+ * to "]" to grafei to shell pou anoixe to trace
+ */
+void trace_stop(void)
+{
+    if (!TRACE_ON)
+    {
+        return;
+    }
+    if (getpid() == trace_pid && write(trace_fd, "\n]\n", 3) < 0)
+    {
+        /* best-effort */
+    }
+    close(trace_fd);
+    trace_fd = -1;
+}
+
+/*
+ * Xekinaei to tracing sto path (to arxeio ginetai truncate)
+ * Returns: 0 se epityxia, -1 se error
+ */
+int trace_start(const char *path)
+{
+    char head[256];
+    if (TRACE_ON)
+    {
+        trace_stop();
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    trace_pid = getpid();
+    int n = snprintf(head, sizeof(head),
+                     "[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"hy345sh\"}}",
+                     (int)trace_pid, (int)trace_pid);
+    if (write(fd, head, n) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    trace_fd = fd;
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ *  csd5127: George Kiosklis
+ *  String helpers kai growable buffers
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#include "hy345sh.h"
+
+/*
+ * Custom strdup function
+ * h kanonikh strdup den etrexe sto qemu opote eftiaxa custom 
+ */
+char *my_strdup(const char *s)
+{
+    char *copy = malloc(strlen(s) + 1);
+    return copy ? strcpy(copy, s) : NULL;
+}
+
+/*
+ * Copy twn prwtwn n xarakthrwn tou s se neo NUL-terminated string
+ */
+char *my_strndup(const char *s, size_t n)
+{
+    char *copy = malloc(n + 1);
+    if (copy != NULL)
+    {
+        memcpy(copy, s, n);
+        copy[n] = '\0';
+    }
+    return copy;
+}
+
+/*
+ * Metatrepei ena wait status se exit code (128+signal gia killed processes)
+ */
+int status_code(int status)
+{
+    if (WIFEXITED(status))
+    {
+        return WEXITSTATUS(status);
+    }
+    if (WIFSIGNALED(status))
+    {
+        return 128 + WTERMSIG(status);
+    }
+    return -1;
+}
+
+/*
+ * Metatrepei ena size opws "65536", "512K", "4M", "1G" se bytes
+ * Returns: to size h -1 an den einai egkyro
+ */
+long parse_size(const char *text)
+{
+    char *end;
+    long size = strtol(text, &end, 10);
+    if (end == text || size < 0)
+    {
+        return -1;
+    }
+    switch (*end)
+    {
+    case 'k':
+    case 'K':
+        size *= 1024;
+        end++;
+        break;
+    case 'm':
+    case 'M':
+        size *= 1024 * 1024;
+        end++;
+        break;
+    case 'g':
+    case 'G':
+        size *= 1024L * 1024 * 1024;
+        end++;
+        break;
+    }
+    return *end == '\0' ? size : -1;
+}
+
+/*
+ * StrBuf: growable string buffer, panta NUL-terminated meta apo append
+ */
+void sb_init(StrBuf *sb)
+{
+    sb->data = NULL;
+    sb->len = 0;
+    sb->cap = 0;
+}
+
+void sb_append(StrBuf *sb, const char *s, size_t n)
+{
+    if (sb->len + n + 1 > sb->cap)
+    {
+        size_t cap = sb->cap ? sb->cap : 256;
+        while (sb->len + n + 1 > cap)
+        {
+            cap *= 2;
+        }
+        char *data = realloc(sb->data, cap);
+        if (data == NULL)
+        {
+            perror("realloc");
+            exit(1);
+        }
+        sb->data = data;
+        sb->cap = cap;
+    }
+    memcpy(sb->data + sb->len, s, n);
+    sb->len += n;
+    sb->data[sb->len] = '\0';
+}
+
+void sb_reset(StrBuf *sb)
+{
+    sb->len = 0;
+    if (sb->data != NULL)
+    {
+        sb->data[0] = '\0';
+    }
+}
+
+void sb_free(StrBuf *sb)
+{
+    free(sb->data);
+    sb_init(sb);
+}
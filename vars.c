@@ -0,0 +1,697 @@
+/*
+ *  csd5127: George Kiosklis
+ *  Shell variables kai variable expansion
+ *
+ *  Indexed arrays (a=(x y z), ${a[i]}, ${a[@]}, ${#a[@]}, a+=(...)): ta elements
+ *  enos array einai ena contiguous vector sto Var.elems, ka8e element
+ *  [uint32 len][bytes]['\0'], opote ena element einai kateu8eian C string kai
+ *  to epomeno vrisketai xwris strlen
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+
+#include "hy345sh.h"
+
+/*
+ * Ola ta global variables, me th seira pou orisththkan, xwris orio sto plh8os
+ * Ta Var erxontai apo slabs kai den metakinountai otan o pinakas megalwnei.
+ * To value einai sto heap, oso xreiazetai, anti gia MAX_VAR_VALUE bytes ana
+ * variable: ena rc me xiliades variables den kanei page faults gia kena values
+ * To lookup ginetai apo ena hash index (open addressing, load <= 1/2), ara
+ * ena megalo rc den kanei to set_var O(n)
+ * Meta apo --restore ta variables tou snapshot menoun sto mapped image (backing)
+ * kai ginontai Var mono otan ta zhthsei to find_var
+ */
+Var **variable = NULL;
+int var_count = 0;
+static int var_cap = 0;
+static Var **var_index = NULL;
+static size_t var_index_size = 0; /* dynamh tou 2 */
+static VarBacking backing;
+
+#define VAR_SLAB 256
+
+/* FNV-1a */
+static size_t var_hash(const char *name)
+{
+    size_t h = 14695981039346656037ULL;
+    for (; *name != '\0'; name++)
+    {
+        h = (h ^ (unsigned char)*name) * 1099511628211ULL;
+    }
+    return h;
+}
+
+static void index_insert(Var *v)
+{
+    size_t mask = var_index_size - 1;
+    size_t i = var_hash(v->name) & mask;
+    while (var_index[i] != NULL)
+    {
+        i = (i + 1) & mask;
+    }
+    var_index[i] = v;
+}
+
+static Var *var_from_image(const char *name);
+
+/* to Var enos onomatos, apo to index h (an den exei ginei akoma Var) apo to backing */
+static Var *find_var(const char *name)
+{
+    if (var_index_size > 0)
+    {
+        size_t mask = var_index_size - 1;
+        for (size_t i = var_hash(name) & mask; var_index[i] != NULL; i = (i + 1) & mask)
+        {
+            if (strcmp(var_index[i]->name, name) == 0)
+            {
+                return var_index[i];
+            }
+        }
+    }
+    return backing.lookup != NULL ? var_from_image(name) : NULL;
+}
+
+/*
+ * Grafei to value (len bytes, xwris '\0') sto v->value
+ * To buffer megalwnei mono an den xwraei, alliws to value allazei sth 8esh tou
+ * Me value_cap 0 to value den einai diko mas buffer (p.x. to "" enos neou variable)
+ */
+static void var_store(Var *v, const char *value, size_t len)
+{
+    if (len + 1 > v->value_cap)
+    {
+        size_t cap = v->value_cap ? v->value_cap : 16;
+        while (cap < len + 1)
+        {
+            cap *= 2;
+        }
+        v->value = realloc(v->value_cap ? v->value : NULL, cap);
+        if (v->value == NULL)
+        {
+            perror("realloc");
+            exit(1);
+        }
+        v->value_cap = cap;
+    }
+    memcpy(v->value, value, len);
+    v->value[len] = '\0';
+}
+
+/* neo Var sto variable[] kai sto index (keno, xwris na metrhthei sto var_stats) */
+static Var *var_alloc(const char *name)
+{
+    if (var_count == var_cap)
+    {
+        var_cap = var_cap ? var_cap * 2 : 64;
+        variable = realloc(variable, var_cap * sizeof(Var *));
+        if (variable == NULL)
+        {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    if ((size_t)(var_count + 1) * 2 > var_index_size)
+    {
+        free(var_index);
+        var_index_size = var_index_size ? var_index_size * 2 : 128;
+        var_index = calloc(var_index_size, sizeof(Var *));
+        if (var_index == NULL)
+        {
+            perror("calloc");
+            exit(1);
+        }
+        for (int i = 0; i < var_count; i++)
+        {
+            index_insert(variable[i]);
+        }
+    }
+    /* ta Var erxontai apo slabs twn VAR_SLAB, ena malloc ana VAR_SLAB variables */
+    static Var *slab = NULL;
+    static int slab_left = 0;
+    if (slab_left == 0)
+    {
+        slab = malloc(VAR_SLAB * sizeof(Var));
+        if (slab == NULL)
+        {
+            perror("malloc");
+            exit(1);
+        }
+        slab_left = VAR_SLAB;
+    }
+    Var *v = slab++;
+    slab_left--;
+    variable[var_count++] = v;
+    strncpy(v->name, name, MAX_VAR_NAME - 1);
+    v->name[MAX_VAR_NAME - 1] = '\0';
+    v->value = ""; /* to prwto var_store desmevei buffer */
+    v->value_cap = 0;
+    v->is_array = 0;
+    v->count = 0;
+    sb_init(&v->elems);
+    index_insert(v);
+    return v;
+}
+
+/* neo (keno) variable */
+static Var *new_var(const char *name)
+{
+    Var *v = var_alloc(name);
+    VAR_STAT_ADD(vars, 1);
+    VAR_STAT_ADD(var_bytes, strlen(v->name));
+    return v;
+}
+
+/*
+ * Ena variable tou backing ginetai Var me to value (h to vector) na deixnei
+ * mesa sto image: value_cap 0 kai elems.cap 0, ara to prwto set_var h
+ * set_array to antigrafei sto heap (copy-on-write, vl. var_store kai var_own)
+ * Einai hdh metrhmeno sto var_stats apo to vars_attach
+ */
+static Var *var_from_image(const char *name)
+{
+    VarImage img;
+    if (strlen(name) >= MAX_VAR_NAME || !backing.lookup(name, &img))
+    {
+        return NULL;
+    }
+    Var *v = var_alloc(name);
+    v->is_array = img.is_array;
+    if (img.is_array)
+    {
+        v->count = img.count;
+        v->elems.data = (char *)img.value; /* read-only, to var_own to antigrafei prin allaxei */
+        v->elems.len = img.len;
+    }
+    else
+    {
+        v->value = (char *)img.value;
+    }
+    return v;
+}
+
+/*
+ * Copy-on-write gia to vector enos array pou deixnei mesa sto backing,
+ * prin to allaxei (h to kanei free) to set_var h to set_array
+ */
+static void var_own(Var *v)
+{
+    if (v->elems.cap == 0 && v->elems.data != NULL)
+    {
+        StrBuf copy;
+        sb_init(&copy);
+        if (v->elems.len > 0)
+        {
+            sb_append(&copy, v->elems.data, v->elems.len);
+        }
+        v->elems = copy;
+    }
+}
+
+/*
+ * Syndeei ena backing store (to snapshot tou --restore): ta variables tou
+ * diavazontai apo ekei otan zhth8oun, anti na ginoun ola Var apo thn arxh
+ * Ena Var pou yparxei hdh kryvei to idio onoma tou backing, ara kaleitai
+ * prin oristei opoiodhpote variable
+ */
+void vars_attach(const VarBacking *b)
+{
+    backing = *b;
+    VAR_STAT_ADD(vars, b->count);
+    VAR_STAT_ADD(var_bytes, b->bytes);
+}
+
+/*
+ * Ola ta variables tou backing ginontai Var, wste to variable[] na ta exei
+ * ola (p.x. gia to snapshot save)
+ */
+void vars_load_all(void)
+{
+    for (uint32_t i = 0; backing.name_at != NULL && i < backing.count; i++)
+    {
+        const char *name = backing.name_at(i);
+        if (name != NULL)
+        {
+            find_var(name);
+        }
+    }
+}
+
+/* ta bytes tou value h tou vector enos variable (gia to var_bytes) */
+static size_t var_size(const Var *v)
+{
+    return v->is_array ? v->elems.len : strlen(v->value);
+}
+
+/*
+ * Anakthsh enos value apo ena shell variable by name
+ * Gia array epistrefei to prwto element (opws to $a sto bash)
+ * Returns: variable value string alliws NULL an den vre8ei
+ */
+char *get_Var(const char *name)
+{
+    Var *v = find_var(name);
+    if (v == NULL)
+    {
+        return NULL;
+    }
+    if (v->is_array)
+    {
+        size_t off = 0;
+        char *first = (char *)array_next(&v->elems, &off);
+        return first != NULL ? first : "";
+    }
+    return v->value;
+}
+
+/*
+ * Set or update a shell variable
+ * An to variable yparxei kanei update to value alliws dhmiourgei neo variable
+ * Ena array pou pairnei scalar value ginetai scalar
+ */
+void set_var(const char *name, const char *value)
+{
+    Var *v = find_var(name);
+    if (v == NULL)
+    {
+        v = new_var(name);
+    }
+    var_own(v);
+    size_t before = var_size(v);
+    if (v->is_array)
+    {
+        sb_free(&v->elems);
+        v->is_array = 0;
+        v->count = 0;
+    }
+    size_t len = strnlen(value, MAX_VAR_VALUE - 1);
+    var_store(v, value, len);
+    VAR_STAT_ADD(var_bytes, len - before);
+}
+
+/* ------------------------------------------------------------ arrays */
+
+/*
+ * Prosthetei ena element (n bytes) sto telos tou vector
+ */
+void array_push(StrBuf *v, const char *s, size_t n)
+{
+    uint32_t len = (uint32_t)n;
+    sb_append(v, (const char *)&len, sizeof(len));
+    sb_append(v, s, n);
+    sb_append(v, "", 1); /* to '\0' tou element einai meros tou vector */
+}
+
+/*
+ * To element sto offset *off, kai to *off proxwraei sto epomeno
+ * Returns: to element (NUL-terminated, mesa sto vector) h NULL sto telos
+ */
+const char *array_next(const StrBuf *v, size_t *off)
+{
+    uint32_t len;
+    if (*off + sizeof(len) > v->len)
+    {
+        return NULL;
+    }
+    memcpy(&len, v->data + *off, sizeof(len));
+    const char *s = v->data + *off + sizeof(len);
+    *off += sizeof(len) + len + 1;
+    return s;
+}
+
+/*
+ * To variable name an einai array
+ * Returns: to Var h NULL (den yparxei h einai scalar)
+ */
+Var *get_array(const char *name)
+{
+    Var *v = find_var(name);
+    return v != NULL && v->is_array ? v : NULL;
+}
+
+/*
+ * To element i tou v (arnhtiko i: apo to telos)
+ * Ena scalar metraei san array me ena element
+ * Returns: to element h NULL an einai ektos oriwn
+ */
+static const char *array_at(const Var *v, long i)
+{
+    if (!v->is_array)
+    {
+        return i == 0 || i == -1 ? v->value : NULL;
+    }
+    if (i < 0)
+    {
+        i += v->count;
+    }
+    if (i < 0 || i >= v->count)
+    {
+        return NULL;
+    }
+    size_t off = 0;
+    const char *s = array_next(&v->elems, &off);
+    while (i-- > 0 && s != NULL)
+    {
+        s = array_next(&v->elems, &off); /* skip me to length prefix, xwris strlen */
+    }
+    return s;
+}
+
+/*
+ * Kanei set (h append) ena array me count elements se vector format
+ * To append se scalar to kanei array me prwto element to palio value
+ */
+void set_array(const char *name, const StrBuf *elems, int count, int append)
+{
+    Var *v = find_var(name);
+    if (v == NULL)
+    {
+        v = new_var(name);
+        append = 0;
+    }
+    var_own(v);
+    size_t before = var_size(v);
+    if (!v->is_array)
+    {
+        sb_init(&v->elems);
+        v->count = 0;
+        if (append)
+        {
+            array_push(&v->elems, v->value, strlen(v->value));
+            v->count = 1;
+        }
+    }
+    else if (!append)
+    {
+        sb_reset(&v->elems);
+        v->count = 0;
+    }
+    if (elems->len > 0)
+    {
+        sb_append(&v->elems, elems->data, elems->len);
+    }
+    v->count += count;
+    v->is_array = 1;
+    if (v->value_cap > 0)
+    {
+        v->value[0] = '\0';
+    }
+    else
+    {
+        v->value = "";
+    }
+    VAR_STAT_ADD(var_bytes, v->elems.len - before);
+}
+
+/*
+ * Ena word apo ena list (p.x. ta words enos for h to (...) enos array)
+ * Ta words xwrizontai me whitespace h ; ektos quotes
+ * Returns: 1 me to word sto raw, 0 sto telos tou list
+ */
+static int next_word(const char **p, StrBuf *raw)
+{
+    const char *s = *p;
+    while (*s == ' ' || *s == '\t' || *s == '\n' || *s == ';')
+    {
+        s++;
+    }
+    if (*s == '\0')
+    {
+        *p = s;
+        return 0;
+    }
+    const char *start = s;
+    int in_quotes = 0;
+    while (*s != '\0' && (in_quotes || (*s != ' ' && *s != '\t' && *s != '\n' && *s != ';')))
+    {
+        if (*s == '"')
+        {
+            in_quotes = !in_quotes;
+        }
+        s++;
+    }
+    sb_reset(raw);
+    sb_append(raw, start, s - start);
+    *p = s;
+    return 1;
+}
+
+/*
+ * An to word einai akrivws "${name[@]}" kai to name einai array
+ * (xwris quotes ta elements spane sta spaces, opote den isxyei)
+ * Returns: to array, alliws NULL
+ */
+Var *array_ref(const char *word)
+{
+    char name[MAX_VAR_NAME];
+    int k = 0;
+    while (*word == ' ' || *word == '\t')
+    {
+        word++;
+    }
+    if (strncmp(word, "\"${", 3) != 0)
+    {
+        return NULL;
+    }
+    word += 3;
+    while ((isalnum((unsigned char)*word) || *word == '_') && k < MAX_VAR_NAME - 1)
+    {
+        name[k++] = *word++;
+    }
+    name[k] = '\0';
+    if (k == 0 || strncmp(word, "[@]}\"", 5) != 0)
+    {
+        return NULL;
+    }
+    word += 5;
+    while (*word == ' ' || *word == '\t' || *word == '\n' || *word == ';')
+    {
+        word++;
+    }
+    return *word == '\0' ? get_array(name) : NULL;
+}
+
+/*
+ * Kanei expand ena list apo words se elements (sto vector out):
+ * "${a[@]}" dinei ta elements tou a opws einai, ena word me quotes dinei ena
+ * element, ena word xwris quotes spaei sta spaces meta to expansion
+ * Returns: to plh8os twn elements
+ */
+int expand_words(const char *words, StrBuf *out)
+{
+    int count = 0;
+    StrBuf raw;
+    sb_init(&raw);
+    const char *p = words;
+    while (next_word(&p, &raw))
+    {
+        Var *arr = array_ref(raw.data);
+        if (arr != NULL)
+        {
+            if (arr->elems.len > 0)
+            {
+                sb_append(out, arr->elems.data, arr->elems.len);
+            }
+            count += arr->count;
+            continue;
+        }
+        int quoted = strchr(raw.data, '"') != NULL;
+        const char *exp = var_expansion(raw.data);
+        if (quoted)
+        {
+            /* ena element, xwris ta quotes */
+            sb_reset(&raw);
+            for (const char *c = exp; *c != '\0'; c++)
+            {
+                if (*c != '"')
+                {
+                    sb_append(&raw, c, 1);
+                }
+            }
+            array_push(out, raw.data, raw.len);
+            count++;
+            continue;
+        }
+        while (*exp != '\0')
+        {
+            size_t skip = strspn(exp, " \t\n");
+            size_t len = strcspn(exp + skip, " \t\n");
+            if (len > 0)
+            {
+                array_push(out, exp + skip, len);
+                count++;
+            }
+            exp += skip + len;
+        }
+    }
+    sb_free(&raw);
+    return count;
+}
+
+/*
+ * name=(w1 w2 ...) h name+=(w1 w2 ...): list einai to keimeno mesa stis parentheseis
+ */
+void assign_array(const char *name, const char *list, int append)
+{
+    StrBuf elems;
+    sb_init(&elems);
+    int count = expand_words(list, &elems); /* prin to set, gia a=("${a[@]}" x) */
+    set_array(name, &elems, count, append);
+    sb_free(&elems);
+}
+
+/* append sto result tou var_expansion (truncate sto MAX_LINE) */
+static int put_result(char *result, int j, const char *s, size_t len)
+{
+    if (len > (size_t)(MAX_LINE - 1 - j))
+    {
+        len = MAX_LINE - 1 - j;
+    }
+    memcpy(result + j, s, len);
+    return j + (int)len;
+}
+
+/* to index enos ${a[i]}: ari8mos h variable (i h $i) */
+static long array_index(const char *idx)
+{
+    if (*idx == '$')
+    {
+        idx++;
+    }
+    if (isalpha((unsigned char)*idx) || *idx == '_')
+    {
+        const char *val = get_Var(idx);
+        return val != NULL ? atol(val) : 0;
+    }
+    return atol(idx);
+}
+
+/*
+ * To expansion enos ${...} (text xwris ta ${ }): ${name}, ${#name},
+ * ${name[i]}, ${name[@]} / ${name[*]} (ta elements me spaces), ${#name[@]}
+ * Returns: to neo j
+ */
+static int expand_braced(const char *text, size_t n, char *result, int j)
+{
+    char inner[MAX_VAR_NAME + 64];
+    char num[24];
+    if (n >= sizeof(inner))
+    {
+        return j;
+    }
+    memcpy(inner, text, n);
+    inner[n] = '\0';
+
+    int length = inner[0] == '#';
+    char *name = inner + length;
+    char *sub = strchr(name, '[');
+    char *close = sub != NULL ? strchr(sub, ']') : NULL;
+    if (sub != NULL)
+    {
+        if (close == NULL || close[1] != '\0')
+        {
+            return j;
+        }
+        *sub++ = '\0';
+        *close = '\0';
+    }
+    Var *v = find_var(name);
+    if (v == NULL)
+    {
+        return j;
+    }
+    int all = sub != NULL && (strcmp(sub, "@") == 0 || strcmp(sub, "*") == 0);
+
+    if (length && all)
+    {
+        snprintf(num, sizeof(num), "%d", v->is_array ? v->count : 1);
+        return put_result(result, j, num, strlen(num));
+    }
+    if (all)
+    {
+        if (!v->is_array)
+        {
+            return put_result(result, j, v->value, strlen(v->value));
+        }
+        size_t off = 0;
+        const char *s;
+        int first = 1;
+        while ((s = array_next(&v->elems, &off)) != NULL)
+        {
+            if (!first)
+            {
+                j = put_result(result, j, " ", 1);
+            }
+            uint32_t len;
+            memcpy(&len, s - sizeof(len), sizeof(len));
+            j = put_result(result, j, s, len);
+            first = 0;
+        }
+        return j;
+    }
+    const char *val = array_at(v, sub != NULL ? array_index(sub) : 0);
+    if (val == NULL)
+    {
+        return j;
+    }
+    if (length)
+    {
+        snprintf(num, sizeof(num), "%zu", strlen(val));
+        return put_result(result, j, num, strlen(num));
+    }
+    return put_result(result, j, val, strlen(val));
+}
+
+/*
+ * Kanei expand ta variables se ena command string
+ * Antika8ista $VAR me ta values tou viriable (supports alphanumeric and underscore)
+ * kai ta ${...} (arrays, vl. expand_braced)
+ * Returns: static buffer me ena expanded string
+ */
+char *var_expansion(const char *input)
+{
+    static char result[MAX_LINE];
+    char var_name[MAX_VAR_NAME];
+    int i=0, j=0;
+    if (TRACE_ON) trace_span('B', "expand", input);
+    while (input[i] != '\0' && j < MAX_LINE - 1)
+    {
+        const char *brace_end = input[i] == '$' && input[i + 1] == '{' ? strchr(input + i + 2, '}') : NULL;
+        if (brace_end != NULL)
+        {
+            j = expand_braced(input + i + 2, brace_end - (input + i + 2), result, j);
+            i = brace_end - input + 1;
+        }
+        else if (input[i] == '$')
+        {
+            i++;
+            int k = 0;
+            while (input[i] != '\0' && (isalnum(input[i]) || input[i] == '_') && k < MAX_VAR_NAME - 1)
+            {
+                var_name[k++]=input[i++];
+            }
+            var_name[k]='\0';
+            char *val=get_Var(var_name);
+            if (val != NULL)
+            {
+                int len=strlen(val);
+                if (j + len < MAX_LINE)
+                {
+                    strcpy(&result[j], val);
+                    j+=len;
+                }
+            }
+        }
+        else
+        {
+            result[j++]=input[i++];
+        }
+    }
+    result[j]='\0';
+    if (TRACE_ON) trace_span('E', "expand", result);
+    return result;
+}
@@ -0,0 +1,407 @@
+/*
+ *  csd5127: George Kiosklis
+ *  Anamonh twn children me pidfd + epoll, kai ta deadlines tou timeout
+ *
+ *  Ka8e child pou perimenoume ginetai ena pidfd (pidfd_open) sto idio epoll
+ *  me ena timerfd gia to deadline, opote to shell perimenei se ena epoll_wait
+ *  "opoio child teleiwsei prwto h to deadline", xwris SIGALRM kai xwris helper
+ *  process. To waitpid ginetai mono gia to child pou einai hdh etoimo
+ *
+ *  timeout DURATION [-s SIG] [-k DURATION] cmd | ...: sto deadline stelnei SIG
+ *  (default SIGTERM) se olo to process group tou pipeline, ara kai sta
+ *  processes pou xekinhsan ta stages (to pipeline exei panta diko tou group,
+ *  vl. pipelining), kai an den exei teleiwsei meta apo to -k (default 1s)
+ *  stelnei SIGKILL
+ *
+ *  Se kernel xwris pidfd_open (< 5.3) to wait ginetai me waitpid, kai me deadline
+ *  me polling ana 1ms
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "hy345sh.h"
+
+#define KILL_AFTER_DEFAULT 1000000000ULL /* 1s apo to SIG mexri to SIGKILL */
+
+static int wait_epfd = -1; /* to epoll menei anoixto gia olo to shell */
+static int wait_timerfd = -1;
+static pid_t wait_owner = 0; /* to process pou ta eftiaxe */
+
+static int pidfd_open_pid(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+/*
+ * To epoll kai to timerfd, mia fora ana process: meta apo fork (p.x. subshell)
+ * to child ftiaxnei ta dika tou, giati ena koino epoll/timerfd 8a anakateve
+ * ta events tou parent me tou child
+ */
+static int wait_setup(void)
+{
+    pid_t self = getpid();
+    if (wait_epfd >= 0 && wait_owner == self)
+    {
+        return 0;
+    }
+    if (wait_epfd >= 0)
+    {
+        close(wait_epfd);
+        close(wait_timerfd);
+    }
+    wait_owner = self;
+    wait_epfd = epoll_create1(EPOLL_CLOEXEC);
+    wait_timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (wait_epfd < 0 || wait_timerfd < 0)
+    {
+        return -1;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = UINT64_MAX; /* ta children exoun to index tous */
+    return epoll_ctl(wait_epfd, EPOLL_CTL_ADD, wait_timerfd, &ev);
+}
+
+/* to timerfd se absolute CLOCK_MONOTONIC xrono (0: disarm) */
+static void timer_arm(uint64_t at_ns)
+{
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = at_ns / 1000000000ULL;
+    its.it_value.tv_nsec = at_ns % 1000000000ULL;
+    timerfd_settime(wait_timerfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+/*
+ * To deadline eftase: SIG sto group, meta SIGKILL
+ * Returns: to epomeno deadline (0 an den yparxei allo)
+ */
+static uint64_t deadline_fire(const WaitDeadline *dl, pid_t pgid, int *stage)
+{
+    if (*stage == 0)
+    {
+        kill(-pgid, dl->sig);
+        if (dl->sig != SIGKILL && dl->sig != SIGCONT)
+        {
+            kill(-pgid, SIGCONT); /* ena stopped process den 8a elavne pote to SIG */
+        }
+        *stage = 1;
+        return dl->sig != SIGKILL && dl->kill_after_ns > 0 ? stats_now_ns() + dl->kill_after_ns : 0;
+    }
+    kill(-pgid, SIGKILL);
+    *stage = 2;
+    return 0;
+}
+
+/*
+ * waitpid mesw wait4, wste to shstat na kratei to peak memory twn children
+ */
+static pid_t reap(pid_t pid, int *status, int flags)
+{
+    struct rusage ru;
+    pid_t r = wait4(pid, status, flags, &ru);
+    if (r > 0)
+    {
+        stats_child_maxrss((uint64_t)ru.ru_maxrss);
+    }
+    return r;
+}
+
+/*
+ * Fallback xwris pidfd: waitpid me th seira, kai me deadline polling ana 1ms
+ */
+static int wait_poll(const pid_t *pids, int n, int *statuses, pid_t pgid, const WaitDeadline *dl)
+{
+    uint64_t next = dl != NULL && pgid > 0 ? dl->deadline_ns : 0;
+    int stage = 0;
+    for (int i = 0; i < n; i++)
+    {
+        while (1)
+        {
+            pid_t r = reap(pids[i], &statuses[i], next != 0 ? WNOHANG : 0);
+            if (r == pids[i] || (r < 0 && errno != EINTR))
+            {
+                break;
+            }
+            if (next != 0 && stats_now_ns() >= next)
+            {
+                next = deadline_fire(dl, pgid, &stage);
+            }
+            else if (next != 0)
+            {
+                struct timespec ms = {0, 1000000};
+                nanosleep(&ms, NULL);
+            }
+        }
+    }
+    return stage > 0;
+}
+
+/*
+ * Perimenei ola ta pids (ta status sto statuses[], 0 gia oposiodhpote error)
+ * Me dl != NULL kai pgid > 0, sto deadline stelnei dl->sig (kai meta SIGKILL)
+ * se olo to group pgid, ara kai sta paidia twn children
+ * Returns: 1 an eftase to deadline, 0 alliws
+ */
+int wait_pids(const pid_t *pids, int n, int *statuses, pid_t pgid, const WaitDeadline *dl)
+{
+    int *pidfds = malloc(n * sizeof(int));
+    int left = 0;
+    int ok = pidfds != NULL && wait_setup() == 0;
+    for (int i = 0; i < n; i++)
+    {
+        statuses[i] = 0;
+        if (pidfds == NULL)
+        {
+            continue;
+        }
+        pidfds[i] = ok ? pidfd_open_pid(pids[i]) : -1;
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u64 = i;
+        if (pidfds[i] >= 0 && epoll_ctl(wait_epfd, EPOLL_CTL_ADD, pidfds[i], &ev) == 0)
+        {
+            left++;
+        }
+        else
+        {
+            ok = 0;
+        }
+    }
+    if (!ok)
+    {
+        for (int i = 0; pidfds != NULL && i < n; i++)
+        {
+            if (pidfds[i] >= 0)
+            {
+                close(pidfds[i]);
+            }
+        }
+        free(pidfds);
+        return wait_poll(pids, n, statuses, pgid, dl);
+    }
+
+    int stage = 0; /* 0: prin to deadline, 1: meta to SIG, 2: meta to SIGKILL */
+    if (dl != NULL && dl->deadline_ns != 0 && pgid > 0)
+    {
+        timer_arm(dl->deadline_ns);
+    }
+    while (left > 0)
+    {
+        struct epoll_event evs[16];
+        int r = epoll_wait(wait_epfd, evs, 16, -1);
+        if (r < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        for (int k = 0; k < r; k++)
+        {
+            if (evs[k].data.u64 == UINT64_MAX)
+            {
+                uint64_t expirations;
+                if (read(wait_timerfd, &expirations, sizeof(expirations)) > 0 && stage < 2)
+                {
+                    uint64_t next = deadline_fire(dl, pgid, &stage);
+                    timer_arm(next);
+                }
+                continue;
+            }
+            int i = (int)evs[k].data.u64;
+            if (pidfds[i] < 0)
+            {
+                continue;
+            }
+            pid_t w;
+            while ((w = reap(pids[i], &statuses[i], WNOHANG)) < 0 && errno == EINTR)
+            {
+            }
+            if (w == 0)
+            {
+                continue; /* den exei teleiwsei akoma (p.x. stopped) */
+            }
+            close(pidfds[i]); /* vgainei kai apo to epoll */
+            pidfds[i] = -1;
+            left--;
+        }
+    }
+    timer_arm(0);
+    for (int i = 0; i < n; i++)
+    {
+        if (pidfds[i] >= 0)
+        {
+            close(pidfds[i]);
+        }
+    }
+    free(pidfds);
+    return stage > 0;
+}
+
+/*
+ * Perimenei to sygkekrimeno child (xwris na kanei reap alla, unrelated children)
+ * To wait status sto *status (0 se error)
+ */
+void wait_for(pid_t pid, int *status)
+{
+    uint64_t start = stats_now_ns();
+    shstat->wait_since = start;
+    wait_pids(&pid, 1, status, 0, NULL);
+    shstat->wait_since = 0;
+    STAT_ADD(wait_ns, stats_now_ns() - start);
+}
+
+/*
+ * Diarkeia opws sto GNU timeout: ari8mos (kai dekadikos) me s, m, h, d,
+ * kai ms gia milliseconds
+ * Returns: ns, h -1 an den einai egkyrh
+ */
+static int64_t parse_duration(const char *text)
+{
+    char *end;
+    errno = 0;
+    double v = strtod(text, &end);
+    if (end == text || errno != 0 || v < 0)
+    {
+        return -1;
+    }
+    double scale = 1e9;
+    if (strcmp(end, "ms") == 0)
+    {
+        scale = 1e6;
+    }
+    else if (strcmp(end, "m") == 0)
+    {
+        scale = 60e9;
+    }
+    else if (strcmp(end, "h") == 0)
+    {
+        scale = 3600e9;
+    }
+    else if (strcmp(end, "d") == 0)
+    {
+        scale = 86400e9;
+    }
+    else if (*end != '\0' && strcmp(end, "s") != 0)
+    {
+        return -1;
+    }
+    return (int64_t)(v * scale);
+}
+
+/* onoma (TERM, SIGTERM) h ari8mos enos signal, -1 an den yparxei */
+static int parse_signal(const char *text)
+{
+    static const struct
+    {
+        const char *name;
+        int sig;
+    } names[] = {{"HUP", SIGHUP}, {"INT", SIGINT},   {"QUIT", SIGQUIT}, {"KILL", SIGKILL},
+                 {"USR1", SIGUSR1}, {"USR2", SIGUSR2}, {"ALRM", SIGALRM}, {"TERM", SIGTERM},
+                 {"CONT", SIGCONT}, {"STOP", SIGSTOP}};
+    char *end;
+    long num = strtol(text, &end, 10);
+    if (end != text && *end == '\0')
+    {
+        return num > 0 && num < NSIG ? (int)num : -1;
+    }
+    if (strncmp(text, "SIG", 3) == 0)
+    {
+        text += 3;
+    }
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        if (strcmp(text, names[i].name) == 0)
+        {
+            return names[i].sig;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Ta options enos timeout prefix (hdh expanded): DURATION [-s SIG] [-k DURATION],
+ * ta options mporoun na einai kai prin to DURATION
+ * Returns: 0 kai to *dl (me absolute deadline apo twra), -1 me mhnyma se error
+ */
+int timeout_parse(const char *options, WaitDeadline *dl)
+{
+    SimpleCmd c;
+    char text[MAX_LINE];
+    strncpy(text, options, MAX_LINE - 1);
+    text[MAX_LINE - 1] = '\0';
+    tokenize_cmd(text, &c);
+
+    int64_t duration = -1;
+    dl->sig = SIGTERM;
+    dl->kill_after_ns = KILL_AFTER_DEFAULT;
+    for (int i = 0; i < c.argc; i++)
+    {
+        if ((strcmp(c.argv[i], "-s") == 0 || strcmp(c.argv[i], "-k") == 0) && i + 1 < c.argc)
+        {
+            if (c.argv[i][1] == 's')
+            {
+                dl->sig = parse_signal(c.argv[i + 1]);
+                if (dl->sig < 0)
+                {
+                    fprintf(stderr, "timeout: invalid signal '%s'\n", c.argv[i + 1]);
+                    return -1;
+                }
+            }
+            else
+            {
+                int64_t k = parse_duration(c.argv[i + 1]);
+                if (k < 0)
+                {
+                    fprintf(stderr, "timeout: invalid duration '%s'\n", c.argv[i + 1]);
+                    return -1;
+                }
+                dl->kill_after_ns = (uint64_t)k;
+            }
+            i++;
+        }
+        else if (duration < 0 && c.argv[i][0] != '-')
+        {
+            duration = parse_duration(c.argv[i]);
+            if (duration < 0)
+            {
+                fprintf(stderr, "timeout: invalid duration '%s'\n", c.argv[i]);
+                return -1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "usage: timeout DURATION [-s SIG] [-k DURATION] cmd [| cmd ...]\n");
+            return -1;
+        }
+    }
+    if (duration < 0)
+    {
+        fprintf(stderr, "usage: timeout DURATION [-s SIG] [-k DURATION] cmd [| cmd ...]\n");
+        return -1;
+    }
+    /* 0 san GNU timeout: xwris deadline */
+    dl->deadline_ns = duration > 0 ? stats_now_ns() + (uint64_t)duration : 0;
+    return 0;
+}